@@ -0,0 +1,205 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/api_handler.h"
+#include "../src/application.h"
+#include "../src/player_tokens.h"
+#include "../src/players.h"
+#include "../src/url_utils.h"
+
+namespace {
+
+using namespace std::literals;
+namespace http = boost::beast::http;
+
+using http_handler::StringRequest;
+
+constexpr std::string_view kMapId = "town"sv;
+
+model::Map MakeTownMap(int size) {
+    model::Map map{model::Map::Id{std::string{kMapId}}, "Town"s};
+    for (int i = 0; i <= size; ++i) {
+        map.AddRoad({model::Road::HORIZONTAL, {0, i * 10}, size * 10});
+        map.AddRoad({model::Road::VERTICAL, {i * 10, 0}, size * 10});
+        map.AddBuilding(model::Building{{{i * 10 + 2, i * 10 + 2}, {6, 6}}});
+    }
+    map.BuildRoadIndex();
+    return map;
+}
+
+// Приложение с player_count игроками на одной карте и опубликованным снимком сессии.
+// Тики вызываются явно, как в режиме без --tick-period.
+struct Server {
+    explicit Server(int player_count)
+        : application{[] {
+                          model::Game game;
+                          game.AddMap(MakeTownMap(10));
+                          return game;
+                      }(),
+                      false, false, 1},
+          handler{application} {
+        for (int i = 0; i < player_count; ++i) {
+            token = application.JoinGame("Player "s + std::to_string(i), std::string{kMapId})
+                        .auth_token;
+        }
+        application.Tick(std::chrono::milliseconds{50});
+    }
+
+    StringRequest Get(std::string_view target) const {
+        StringRequest req{http::verb::get, target, 11};
+        req.set(http::field::authorization, "Bearer "s + token);
+        return req;
+    }
+
+    StringRequest Post(std::string_view target, std::string_view body) const {
+        StringRequest req{http::verb::post, target, 11};
+        req.set(http::field::authorization, "Bearer "s + token);
+        req.set(http::field::content_type, "application/json"sv);
+        req.body() = body;
+        req.prepare_payload();
+        return req;
+    }
+
+    app::Application application;
+    http_handler::ApiHandler handler;
+    std::string token;
+};
+
+// Запрос копируется на каждой итерации: обработчик получает его по rvalue-ссылке,
+// как из соединения. Копия нескольких заголовков заметно дешевле самой обработки.
+void HandleLoop(benchmark::State& state, Server& server, const StringRequest& prototype) {
+    for (auto _ : state) {
+        auto response = server.handler.Handle(StringRequest{prototype});
+        benchmark::DoNotOptimize(response);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Таблица токенов хранит только указатель на игрока, поэтому всем токенам достаточно одного
+struct TokenOwner {
+    TokenOwner() {
+        game.AddMap(MakeTownMap(1));
+        id = players.AddPlayer(game.GetOrCreateSession(model::Map::Id{std::string{kMapId}}),
+                               "Player"s, false);
+    }
+
+    model::Player* Get() { return players.Find(id); }
+
+    model::Game game;
+    app::Players players;
+    model::Player::Id id = 0;
+};
+
+void BM_TokensIssue(benchmark::State& state) {
+    TokenOwner owner;
+    model::Player* player = owner.Get();
+
+    const auto count = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tokens = std::make_unique<app::PlayerTokens>();
+        state.ResumeTiming();
+        for (int64_t i = 0; i < count; ++i) {
+            benchmark::DoNotOptimize(tokens->Issue(player));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_TokensIssue)->RangeMultiplier(10)->Range(10, 100'000);
+
+// Поиск по таблице с state.range(0) токенами, как при проверке заголовка Authorization
+void BM_TokensFindPlayer(benchmark::State& state) {
+    TokenOwner owner;
+    app::PlayerTokens tokens;
+    std::vector<std::string> issued;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        issued.push_back(*tokens.Issue(owner.Get()));
+    }
+
+    std::size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tokens.FindPlayer(issued[next]));
+        next = next + 1 == issued.size() ? 0 : next + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TokensFindPlayer)->RangeMultiplier(10)->Range(10, 100'000);
+
+// Обработка запроса к каждой точке API в сессии с state.range(0) игроками
+
+void BM_ApiMaps(benchmark::State& state) {
+    Server server{static_cast<int>(state.range(0))};
+    HandleLoop(state, server, server.Get(http_handler::Endpoint::MAPS));
+}
+BENCHMARK(BM_ApiMaps)->Arg(1);
+
+void BM_ApiMap(benchmark::State& state) {
+    Server server{static_cast<int>(state.range(0))};
+    HandleLoop(state, server, server.Get("/api/v1/maps/town"sv));
+}
+BENCHMARK(BM_ApiMap)->Arg(1);
+
+// Каждый запрос добавляет игрока, поэтому через kJoinsPerServer запросов сервер создаётся
+// заново вне замера: в сессии остаётся от range(0) до range(0) + kJoinsPerServer игроков
+void BM_ApiJoin(benchmark::State& state) {
+    constexpr int kJoinsPerServer = 100;
+    const auto player_count = static_cast<int>(state.range(0));
+
+    auto server = std::make_unique<Server>(player_count);
+    const auto prototype = server->Post(http_handler::Endpoint::JOIN,
+                                        R"({"userName": "Scooby Doo", "mapId": "town"})"sv);
+    int joins = 0;
+    for (auto _ : state) {
+        if (joins == kJoinsPerServer) {
+            state.PauseTiming();
+            server.reset();
+            server = std::make_unique<Server>(player_count);
+            joins = 0;
+            state.ResumeTiming();
+        }
+        auto response = server->handler.Handle(StringRequest{prototype});
+        benchmark::DoNotOptimize(response);
+        ++joins;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ApiJoin)->RangeMultiplier(10)->Range(1, 10'000);
+
+void BM_ApiPlayers(benchmark::State& state) {
+    Server server{static_cast<int>(state.range(0))};
+    HandleLoop(state, server, server.Get(http_handler::Endpoint::PLAYERS));
+}
+BENCHMARK(BM_ApiPlayers)->RangeMultiplier(10)->Range(1, 10'000);
+
+// state.range(1) != 0 - снимок в двоичном формате
+void BM_ApiState(benchmark::State& state) {
+    Server server{static_cast<int>(state.range(0))};
+    auto req = server.Get(http_handler::Endpoint::STATE);
+    if (state.range(1)) {
+        req.set(http::field::accept, http_handler::ContentType::GAME_BINARY);
+    }
+    HandleLoop(state, server, req);
+}
+BENCHMARK(BM_ApiState)->ArgsProduct({{1, 100, 10'000}, {0, 1}});
+
+void BM_ApiAction(benchmark::State& state) {
+    Server server{static_cast<int>(state.range(0))};
+    HandleLoop(state, server,
+               server.Post(http_handler::Endpoint::ACTION, R"({"move": "L"})"sv));
+}
+BENCHMARK(BM_ApiAction)->RangeMultiplier(10)->Range(1, 10'000);
+
+// Тик двигает всех собак сессии и публикует новый снимок
+void BM_ApiTick(benchmark::State& state) {
+    Server server{static_cast<int>(state.range(0))};
+    HandleLoop(state, server,
+               server.Post(http_handler::Endpoint::TICK, R"({"timeDelta": 50})"sv));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ApiTick)->RangeMultiplier(10)->Range(1, 10'000);
+
+}  // namespace
@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/model.h"
+#include "../src/session.h"
+
+namespace {
+
+using namespace std::literals;
+
+constexpr int kBlockSize = 10;
+constexpr int kDogsPerTick = 1000;
+constexpr double kTickSeconds = 0.05;
+
+// Карта-решётка: квадраты kBlockSize x kBlockSize, каждая сторона квадрата - отдельная дорога
+model::Map MakeGridMap(int road_count) {
+    model::Map map{model::Map::Id{"bench"s}, "bench"s};
+
+    int side = 1;
+    while (2 * side * (side + 1) < road_count) {
+        ++side;
+    }
+
+    int added = 0;
+    for (int row = 0; row <= side && added < road_count; ++row) {
+        for (int col = 0; col < side && added < road_count; ++col) {
+            const int x = col * kBlockSize, y = row * kBlockSize;
+            map.AddRoad({model::Road::HORIZONTAL, {x, y}, x + kBlockSize});
+            ++added;
+            if (added < road_count) {
+                map.AddRoad({model::Road::VERTICAL, {y, x}, x + kBlockSize});
+                ++added;
+            }
+        }
+    }
+    map.BuildRoadIndex();
+    return map;
+}
+
+struct Dog {
+    model::DogPos pos;
+    model::DogVelocity velocity;
+};
+
+std::vector<Dog> PlaceDogs(const model::Map& map, int count) {
+    std::mt19937 gen{42};
+    const auto& roads = map.GetRoads();
+    std::uniform_int_distribution<size_t> road_dist(0, roads.size() - 1);
+    std::uniform_real_distribution<double> offset_dist(0.0, 1.0);
+
+    std::vector<Dog> dogs;
+    dogs.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const auto& road = roads[road_dist(gen)];
+        const auto a = road.GetStart(), b = road.GetEnd();
+        const double t = offset_dist(gen);
+        model::DogPos pos{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t};
+        model::DogVelocity velocity =
+            road.IsHorizontal() ? model::DogVelocity{3.0, 0.0} : model::DogVelocity{0.0, 3.0};
+        dogs.push_back({pos, velocity});
+    }
+    return dogs;
+}
+
+// Один тик для kDogsPerTick собак на карте с state.range(0) дорогами
+void BM_ProjectMove(benchmark::State& state) {
+    const auto map = MakeGridMap(static_cast<int>(state.range(0)));
+    auto dogs = PlaceDogs(map, kDogsPerTick);
+
+    for (auto _ : state) {
+        for (auto& dog : dogs) {
+            auto result = map.ProjectMove(dog.pos, dog.velocity, kTickSeconds);
+            if (result.stopped_by_boundary) {
+                dog.velocity = {-dog.velocity.vx, -dog.velocity.vy};
+            }
+            dog.pos = result.new_pos;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kDogsPerTick);
+}
+BENCHMARK(BM_ProjectMove)->RangeMultiplier(10)->Range(10, 100'000);
+
+void BM_FindRoadAt(benchmark::State& state) {
+    const auto map = MakeGridMap(static_cast<int>(state.range(0)));
+    const auto dogs = PlaceDogs(map, kDogsPerTick);
+
+    for (auto _ : state) {
+        for (const auto& dog : dogs) {
+            benchmark::DoNotOptimize(map.FindRoadAt(dog.pos));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kDogsPerTick);
+}
+BENCHMARK(BM_FindRoadAt)->RangeMultiplier(10)->Range(10, 100'000);
+
+// Построение индекса дорог при загрузке карты
+void BM_BuildRoadIndex(benchmark::State& state) {
+    auto map = MakeGridMap(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        map.BuildRoadIndex();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildRoadIndex)->RangeMultiplier(10)->Range(10, 100'000);
+
+constexpr int kSpawnWave = 10'000;
+
+// Волна из kSpawnWave точек на дорогах: время не должно зависеть от числа дорог
+void BM_GetRandomRoadPoints(benchmark::State& state) {
+    const auto map = MakeGridMap(static_cast<int>(state.range(0)));
+    std::mt19937 gen{42};
+
+    for (auto _ : state) {
+        auto points = map.GetRandomRoadPoints(gen, kSpawnWave);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kSpawnWave);
+}
+BENCHMARK(BM_GetRandomRoadPoints)->RangeMultiplier(10)->Range(10, 100'000);
+
+constexpr int kSessionRoads = 1000;
+
+// Прежняя схема тика: собаки разбросаны по узлам unordered_map, каждая идёт через ProjectMove
+void BM_TickPerDog(benchmark::State& state) {
+    const auto map = MakeGridMap(kSessionRoads);
+    const int dog_count = static_cast<int>(state.range(0));
+
+    std::unordered_map<int, Dog> dogs;
+    std::vector<int> ids;
+    int id = 0;
+    for (const auto& dog : PlaceDogs(map, dog_count)) {
+        dogs.emplace(id, dog);
+        ids.push_back(id++);
+    }
+
+    for (auto _ : state) {
+        for (const int dog_id : ids) {
+            auto& dog = dogs.at(dog_id);
+            auto result = map.ProjectMove(dog.pos, dog.velocity, kTickSeconds);
+            if (result.stopped_by_boundary) {
+                dog.velocity = {0.0, 0.0};
+            }
+            dog.pos = result.new_pos;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * dog_count);
+}
+BENCHMARK(BM_TickPerDog)->RangeMultiplier(10)->Range(1'000, 100'000);
+
+// Тик сессии по структуре массивов DogStore
+void BM_TickSession(benchmark::State& state) {
+    const auto map = MakeGridMap(kSessionRoads);
+    const int dog_count = static_cast<int>(state.range(0));
+
+    model::GameSession session{&map};
+    for (const auto& dog : PlaceDogs(map, dog_count)) {
+        session.GetDogs().Add(dog.pos, dog.velocity);
+    }
+
+    for (auto _ : state) {
+        session.Tick(kTickSeconds);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * dog_count);
+}
+BENCHMARK(BM_TickSession)->RangeMultiplier(10)->Range(1'000, 100'000);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+
+#include <boost/json.hpp>
+#include <random>
+#include <string>
+
+#include "../src/binary_codec.h"
+#include "../src/json_serializer.h"
+#include "../src/session.h"
+#include "../src/url_utils.h"
+
+namespace {
+
+using namespace std::literals;
+
+// Снимок сессии с state.range(0) собаками, разбросанными по карте-решётке
+std::shared_ptr<model::SessionState> MakeState(const model::Map& map, int dog_count) {
+    static std::mt19937 gen{42};
+    std::uniform_real_distribution<double> coord(0.0, 100.0);
+    std::uniform_int_distribution<int> dir(0, 3);
+
+    model::GameSession session{&map};
+    for (int i = 0; i < dog_count; ++i) {
+        session.GetDogs().Add({coord(gen), coord(gen)}, {coord(gen) / 25.0, 0.0},
+                              static_cast<model::DogDirection>(dir(gen)));
+        session.AddToRoster(i, "Player "s + std::to_string(i));
+    }
+    return session.CaptureState();
+}
+
+model::Map MakeMap(int size) {
+    model::Map map{model::Map::Id{"bench"s}, "bench"s};
+    for (int i = 0; i <= size; ++i) {
+        map.AddRoad({model::Road::HORIZONTAL, {0, i * 10}, size * 10});
+        map.AddRoad({model::Road::VERTICAL, {i * 10, 0}, size * 10});
+        map.AddBuilding(model::Building{{{i * 10 + 2, i * 10 + 2}, {6, 6}}});
+    }
+    map.BuildRoadIndex();
+    return map;
+}
+
+template <typename Encode>
+void EncodeState(benchmark::State& bench, Encode&& encode) {
+    const auto map = MakeMap(10);
+    const auto state = MakeState(map, static_cast<int>(bench.range(0)));
+
+    std::size_t bytes = 0;
+    for (auto _ : bench) {
+        auto body = encode(*state);
+        bytes = body.size();
+        benchmark::DoNotOptimize(body);
+    }
+    bench.SetItemsProcessed(bench.iterations() * bench.range(0));
+    bench.SetBytesProcessed(bench.iterations() * bytes);
+    bench.counters["bytes_per_dog"] = static_cast<double>(bytes) / bench.range(0);
+}
+
+void BM_EncodeStateJson(benchmark::State& bench) {
+    EncodeState(bench, json_serialization::SerializeSessionState);
+}
+BENCHMARK(BM_EncodeStateJson)->RangeMultiplier(10)->Range(10, 10'000);
+
+void BM_EncodeStateBinary(benchmark::State& bench) {
+    EncodeState(bench, binary_protocol::EncodeState);
+}
+BENCHMARK(BM_EncodeStateBinary)->RangeMultiplier(10)->Range(10, 10'000);
+
+void BM_DecodeStateJson(benchmark::State& bench) {
+    const auto map = MakeMap(10);
+    const auto body =
+        json_serialization::SerializeSessionState(*MakeState(map, static_cast<int>(bench.range(0))));
+
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(boost::json::parse(body));
+    }
+    bench.SetItemsProcessed(bench.iterations() * bench.range(0));
+    bench.SetBytesProcessed(bench.iterations() * body.size());
+}
+BENCHMARK(BM_DecodeStateJson)->RangeMultiplier(10)->Range(10, 10'000);
+
+void BM_DecodeStateBinary(benchmark::State& bench) {
+    const auto map = MakeMap(10);
+    const auto body =
+        binary_protocol::EncodeState(*MakeState(map, static_cast<int>(bench.range(0))));
+
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(binary_protocol::DecodeState(body));
+    }
+    bench.SetItemsProcessed(bench.iterations() * bench.range(0));
+    bench.SetBytesProcessed(bench.iterations() * body.size());
+}
+BENCHMARK(BM_DecodeStateBinary)->RangeMultiplier(10)->Range(10, 10'000);
+
+// Размер описания карты с state.range(0) x state.range(0) кварталами
+void BM_EncodeMapJson(benchmark::State& bench) {
+    const auto map = MakeMap(static_cast<int>(bench.range(0)));
+    std::size_t bytes = 0;
+    for (auto _ : bench) {
+        auto body = boost::json::serialize(json_serialization::GetMapData(&map));
+        bytes = body.size();
+        benchmark::DoNotOptimize(body);
+    }
+    bench.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_EncodeMapJson)->Arg(10)->Arg(100);
+
+void BM_EncodeMapBinary(benchmark::State& bench) {
+    const auto map = MakeMap(static_cast<int>(bench.range(0)));
+    std::size_t bytes = 0;
+    for (auto _ : bench) {
+        auto body = binary_protocol::EncodeMap(map);
+        bytes = body.size();
+        benchmark::DoNotOptimize(body);
+    }
+    bench.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_EncodeMapBinary)->Arg(10)->Arg(100);
+
+void BM_GetRoadsFromMap(benchmark::State& bench) {
+    const auto map = MakeMap(static_cast<int>(bench.range(0)));
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(json_serialization::GetRoadsFromMap(&map));
+    }
+    bench.SetItemsProcessed(bench.iterations() * static_cast<int64_t>(map.GetRoads().size()));
+}
+BENCHMARK(BM_GetRoadsFromMap)->Arg(10)->Arg(100);
+
+// Идентификатор карты из адресной строки: без экранирования и полностью в %XX
+void BM_DecodeURI(benchmark::State& bench) {
+    std::string uri = "/api/v1/maps/"s;
+    for (int i = 0; i < bench.range(0); ++i) {
+        uri += bench.range(1) ? "%6D"sv : "m"sv;
+    }
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(http_handler::url::DecodeURI(uri));
+    }
+    bench.SetBytesProcessed(bench.iterations() * static_cast<int64_t>(uri.size()));
+}
+BENCHMARK(BM_DecodeURI)->ArgsProduct({{8, 64}, {0, 1}});
+
+}  // namespace
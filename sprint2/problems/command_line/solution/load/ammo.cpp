@@ -0,0 +1,86 @@
+#include "ammo.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace load {
+
+using namespace std::literals;
+
+namespace {
+
+std::string_view Trim(std::string_view s) {
+    const auto first = s.find_first_not_of(" \t\r"sv);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    const auto last = s.find_last_not_of(" \t\r"sv);
+    return s.substr(first, last - first + 1);
+}
+
+void SetHeader(std::vector<Header>& headers, std::string_view line, const std::string& where) {
+    const auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+        throw std::runtime_error("Invalid header at "s + where);
+    }
+    std::string name{Trim(line.substr(0, colon))};
+    std::string value{Trim(line.substr(colon + 1))};
+    if (name.empty()) {
+        throw std::runtime_error("Empty header name at "s + where);
+    }
+
+    auto it = std::find_if(headers.begin(), headers.end(),
+                           [&name](const Header& header) { return header.first == name; });
+    if (it != headers.end()) {
+        it->second = std::move(value);
+    } else {
+        headers.emplace_back(std::move(name), std::move(value));
+    }
+}
+
+}  // namespace
+
+std::vector<Shot> ReadAmmo(const std::filesystem::path& path) {
+    std::ifstream in{path};
+    if (!in) {
+        throw std::runtime_error("Failed to open ammo file: "s + path.string());
+    }
+
+    std::vector<Shot> shots;
+    std::vector<Header> headers;
+    std::string line;
+    for (int line_number = 1; std::getline(in, line); ++line_number) {
+        const auto text = Trim(line);
+        if (text.empty() || text.front() == '#') {
+            continue;
+        }
+
+        if (text.front() == '[') {
+            if (text.back() != ']') {
+                throw std::runtime_error("Unterminated header at "s + path.string() + ':' +
+                                         std::to_string(line_number));
+            }
+            SetHeader(headers, text.substr(1, text.size() - 2),
+                      path.string() + ':' + std::to_string(line_number));
+            continue;
+        }
+
+        const auto space = text.find_first_of(" \t"sv);
+        Shot shot;
+        shot.uri = text.substr(0, space);
+        if (space != std::string_view::npos) {
+            shot.tag = Trim(text.substr(space));
+        }
+        shot.headers = headers;
+        shots.push_back(std::move(shot));
+    }
+
+    if (shots.empty()) {
+        throw std::runtime_error("No requests in ammo file: "s + path.string());
+    }
+    return shots;
+}
+
+}  // namespace load
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace load {
+
+using Header = std::pair<std::string, std::string>;
+
+// Один «патрон»: GET-запрос и заголовки, действовавшие на момент его объявления
+struct Shot {
+    std::string uri;
+    std::string tag;
+    std::vector<Header> headers;
+};
+
+// Читает патроны в формате phantom (ammo_type: uri), как в load.yaml для yandex-tank:
+//   [Name: value]   заголовок для всех следующих запросов (повторное имя заменяет значение)
+//   /path [tag]     запрос
+// Пустые строки и строки, начинающиеся с '#', пропускаются.
+// Выбрасывает std::runtime_error, если файл не прочитан или в нём нет запросов.
+std::vector<Shot> ReadAmmo(const std::filesystem::path& path);
+
+}  // namespace load
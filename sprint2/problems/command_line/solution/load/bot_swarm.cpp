@@ -0,0 +1,593 @@
+#include "bot_swarm.h"
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "latency.h"
+
+namespace load {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace sys = boost::system;
+using net::ip::tcp;
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Strand = net::strand<net::io_context::executor_type>;
+
+enum class Kind : std::uint8_t { Join, Action, State, Players };
+constexpr std::size_t kKindCount = 4;
+constexpr std::array<std::string_view, kKindCount> kKindNames = {"join"sv, "action"sv, "state"sv,
+                                                                 "players"sv};
+constexpr std::array<std::string_view, 5> kMoves = {"L"sv, "R"sv, "U"sv, "D"sv, ""sv};
+constexpr auto kJoinRetryDelay = 1s;
+
+std::size_t Index(Kind kind) {
+    return static_cast<std::size_t>(kind);
+}
+
+// Значения строковых полей key из ответа API. Ответы сервера компактные, а нужные поля
+// (id карт, токен) не содержат экранированных символов, поэтому разбор JSON не нужен
+std::vector<std::string> FindJsonStrings(std::string_view body, std::string_view key) {
+    std::vector<std::string> values;
+    const std::string pattern = "\""s + std::string{key} + "\""s;
+    for (auto pos = body.find(pattern); pos != std::string_view::npos;
+         pos = body.find(pattern, pos)) {
+        pos += pattern.size();
+        pos = body.find_first_not_of(" \t\r\n"sv, pos);
+        if (pos == std::string_view::npos || body[pos] != ':') {
+            continue;
+        }
+        pos = body.find_first_not_of(" \t\r\n"sv, pos + 1);
+        if (pos == std::string_view::npos || body[pos] != '"') {
+            continue;
+        }
+        const auto end = body.find('"', pos + 1);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        values.emplace_back(body.substr(pos + 1, end - pos - 1));
+        pos = end;
+    }
+    return values;
+}
+
+// Статистика прогона. Боты пишут в неё из разных потоков, поэтому она под мьютексом:
+// на одну запись приходится сетевой запрос, так что блокировка заметной не будет
+class SwarmStats {
+   public:
+    struct KindStats {
+        LatencySample latency;
+        std::uint64_t errors = 0;
+        // Запрос не отправлен, потому что такой же ещё не выполнен
+        std::uint64_t skipped = 0;
+    };
+    using Table = std::array<KindStats, kKindCount>;
+
+    void Record(Kind kind, std::chrono::nanoseconds latency, bool ok) {
+        std::lock_guard lock{mutex_};
+        auto& stats = interval_[Index(kind)];
+        stats.latency.Add(latency);
+        stats.errors += ok ? 0 : 1;
+    }
+
+    void Skip(Kind kind) {
+        std::lock_guard lock{mutex_};
+        ++interval_[Index(kind)].skipped;
+    }
+
+    // Возвращает статистику с прошлого вызова и добавляет её к итоговой
+    Table TakeInterval() {
+        std::lock_guard lock{mutex_};
+        Table interval = std::move(interval_);
+        interval_ = {};
+        for (std::size_t i = 0; i < kKindCount; ++i) {
+            total_[i].latency.Append(interval[i].latency);
+            total_[i].errors += interval[i].errors;
+            total_[i].skipped += interval[i].skipped;
+        }
+        return interval;
+    }
+
+    Table TakeTotal() {
+        TakeInterval();
+        std::lock_guard lock{mutex_};
+        return std::move(total_);
+    }
+
+   private:
+    std::mutex mutex_;
+    Table interval_;
+    Table total_;
+};
+
+class Swarm;
+
+// Один игрок. Все его операции выполняются в собственном strand, запросы идут по одному
+// keep-alive соединению. Задержка считается от момента, когда запрос должен был уйти, поэтому
+// ожидание своей очереди внутри бота тоже попадает в статистику.
+class Bot : public std::enable_shared_from_this<Bot> {
+   public:
+    Bot(net::io_context& ioc, Swarm& swarm, std::string name, std::string map_id,
+        std::uint32_t seed)
+        : strand_{net::make_strand(ioc)},
+          swarm_{swarm},
+          name_{std::move(name)},
+          map_id_{std::move(map_id)},
+          random_{seed} {}
+
+    void Start() {
+        net::dispatch(strand_, [self = shared_from_this()] {
+            self->Enqueue(Kind::Join, Clock::now());
+        });
+    }
+
+    void Stop() {
+        net::dispatch(strand_, [self = shared_from_this()] {
+            self->stopped_ = true;
+            self->state_timer_.cancel();
+            self->action_timer_.cancel();
+            self->queue_.clear();
+            self->stream_.close();
+        });
+    }
+
+   private:
+    struct Pending {
+        Kind kind;
+        Clock::time_point scheduled;
+    };
+
+    // Как в game.js, запрос каждого типа не отправляется повторно, пока не пришёл ответ
+    void Enqueue(Kind kind, Clock::time_point scheduled);
+    void SendNext();
+    void PrepareRequest(Kind kind);
+    void Connect();
+    void Write();
+    void Read();
+    void OnResponse(sys::error_code ec);
+    void OnJoined(bool ok);
+
+    void ScheduleState();
+    void ScheduleAction();
+
+    Strand strand_;
+    Swarm& swarm_;
+    std::string name_;
+    std::string map_id_;
+    std::mt19937 random_;
+
+    beast::tcp_stream stream_{strand_};
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    http::response<http::string_body> response_;
+
+    std::deque<Pending> queue_;
+    std::array<bool, kKindCount> pending_{};
+    std::optional<Pending> current_;
+    std::string token_;
+    bool stopped_ = false;
+
+    net::steady_timer state_timer_{strand_};
+    net::steady_timer action_timer_{strand_};
+    Clock::time_point next_state_;
+    Clock::time_point next_action_;
+    std::uint64_t polls_ = 0;
+};
+
+class Swarm {
+   public:
+    Swarm(net::io_context& ioc, const SwarmOptions& options, tcp::resolver::results_type endpoints,
+          std::vector<std::string> maps, std::ostream& out)
+        : ioc_{ioc},
+          options_{options},
+          endpoints_{std::move(endpoints)},
+          maps_{std::move(maps)},
+          out_{out} {}
+
+    void Start() {
+        net::dispatch(strand_, [this] {
+            start_ = last_report_ = Clock::now();
+            signals_.async_wait([this](sys::error_code ec, int) {
+                if (!ec) {
+                    Stop();
+                }
+            });
+            end_timer_.expires_at(start_ + options_.duration);
+            end_timer_.async_wait([this](sys::error_code ec) {
+                if (!ec) {
+                    Stop();
+                }
+            });
+            out_ << "  time      bots      rps  latency p50 / p99 by request, errors, skipped\n";
+            SpawnDue();
+            ScheduleReport();
+        });
+    }
+
+    // Итог выводится после того, как io_context::run вернул управление
+    void PrintTotal() {
+        const auto total = stats_.TakeTotal();
+        const double seconds = std::chrono::duration<double>(stopped_at_ - start_).count();
+
+        std::uint64_t requests = 0;
+        for (const auto& kind : total) {
+            requests += kind.latency.Count();
+        }
+
+        out_ << std::fixed << std::setprecision(1) << "\nBots:     " << bots_.size()
+             << " started, " << joined_.load() << " joined, on " << maps_.size() << " maps\n";
+        out_ << "Requests: " << requests << " in " << seconds << " s ("
+             << (seconds > 0 ? static_cast<double>(requests) / seconds : 0.0) << " rps)\n";
+        out_ << "request       count   errors  skipped       p50       p99     p99.9       max\n";
+        for (std::size_t i = 0; i < kKindCount; ++i) {
+            const auto summary = total[i].latency.Summarize();
+            out_ << std::left << std::setw(8) << kKindNames[i] << std::right << std::setw(12)
+                 << summary.count << std::setw(9) << total[i].errors << std::setw(9)
+                 << total[i].skipped << std::setw(10) << FormatMs(summary.p50) << std::setw(10)
+                 << FormatMs(summary.p99) << std::setw(10) << FormatMs(summary.p999)
+                 << std::setw(10) << FormatMs(summary.max) << '\n';
+        }
+    }
+
+    SwarmStats& Stats() { return stats_; }
+    const SwarmOptions& Options() const { return options_; }
+    const tcp::resolver::results_type& Endpoints() const { return endpoints_; }
+
+    void OnBotJoined() { joined_.fetch_add(1, std::memory_order_relaxed); }
+
+   private:
+    // Создаёт ботов, время подключения которых наступило
+    void SpawnDue() {
+        const auto now = Clock::now();
+        while (!stopping_ && bots_.size() < options_.bots && SpawnTime(bots_.size()) <= now) {
+            const std::size_t index = bots_.size();
+            auto bot = std::make_shared<Bot>(ioc_, *this, "bot-"s + std::to_string(index),
+                                             maps_[index % maps_.size()],
+                                             static_cast<std::uint32_t>(index));
+            bot->Start();
+            bots_.push_back(std::move(bot));
+        }
+        if (stopping_ || bots_.size() == options_.bots) {
+            return;
+        }
+        spawn_timer_.expires_at(SpawnTime(bots_.size()));
+        spawn_timer_.async_wait([this](sys::error_code ec) {
+            if (!ec) {
+                SpawnDue();
+            }
+        });
+    }
+
+    Clock::time_point SpawnTime(std::size_t index) const {
+        return start_ + std::chrono::duration_cast<Clock::duration>(
+                            options_.ramp * static_cast<double>(index) /
+                            static_cast<double>(options_.bots));
+    }
+
+    void ScheduleReport() {
+        report_timer_.expires_at(last_report_ + options_.report_interval);
+        report_timer_.async_wait([this](sys::error_code ec) {
+            if (!ec) {
+                PrintInterval(Clock::now());
+                ScheduleReport();
+            }
+        });
+    }
+
+    void PrintInterval(Clock::time_point now) {
+        const auto interval = stats_.TakeInterval();
+        const double seconds = std::chrono::duration<double>(now - last_report_).count();
+        last_report_ = now;
+
+        std::uint64_t requests = 0, errors = 0, skipped = 0;
+        for (const auto& kind : interval) {
+            requests += kind.latency.Count();
+            errors += kind.errors;
+            skipped += kind.skipped;
+        }
+
+        out_ << std::fixed << std::setprecision(1) << std::setw(5)
+             << std::chrono::duration<double>(now - start_).count() << " s" << std::setw(10)
+             << joined_.load(std::memory_order_relaxed) << std::setw(9)
+             << (seconds > 0 ? static_cast<double>(requests) / seconds : 0.0);
+        for (std::size_t i = 0; i < kKindCount; ++i) {
+            if (interval[i].latency.Count() > 0) {
+                const auto summary = interval[i].latency.Summarize();
+                out_ << "  " << kKindNames[i] << ' ' << FormatMs(summary.p50) << " / "
+                     << FormatMs(summary.p99);
+            }
+        }
+        out_ << ", " << errors << ", " << skipped << std::endl;
+    }
+
+    void Stop() {
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        stopped_at_ = Clock::now();
+        spawn_timer_.cancel();
+        report_timer_.cancel();
+        end_timer_.cancel();
+        signals_.cancel();
+        PrintInterval(stopped_at_);
+        for (const auto& bot : bots_) {
+            bot->Stop();
+        }
+    }
+
+    net::io_context& ioc_;
+    const SwarmOptions& options_;
+    tcp::resolver::results_type endpoints_;
+    std::vector<std::string> maps_;
+    std::ostream& out_;
+    SwarmStats stats_;
+
+    Strand strand_{net::make_strand(ioc_)};
+    net::steady_timer spawn_timer_{strand_};
+    net::steady_timer report_timer_{strand_};
+    net::steady_timer end_timer_{strand_};
+    net::signal_set signals_{strand_, SIGINT};
+
+    Clock::time_point start_;
+    Clock::time_point last_report_;
+    Clock::time_point stopped_at_;
+    std::vector<std::shared_ptr<Bot>> bots_;
+    std::atomic<std::size_t> joined_{0};
+    bool stopping_ = false;
+};
+
+void Bot::Enqueue(Kind kind, Clock::time_point scheduled) {
+    if (stopped_) {
+        return;
+    }
+    if (pending_[Index(kind)]) {
+        swarm_.Stats().Skip(kind);
+        return;
+    }
+    pending_[Index(kind)] = true;
+    queue_.push_back({kind, scheduled});
+    if (!current_) {
+        SendNext();
+    }
+}
+
+void Bot::SendNext() {
+    if (queue_.empty() || stopped_) {
+        return;
+    }
+    current_ = queue_.front();
+    queue_.pop_front();
+    PrepareRequest(current_->kind);
+
+    if (stream_.socket().is_open()) {
+        Write();
+    } else {
+        Connect();
+    }
+}
+
+void Bot::PrepareRequest(Kind kind) {
+    request_ = {};
+    request_.version(11);
+    request_.set(http::field::host, swarm_.Options().host);
+    request_.keep_alive(true);
+
+    switch (kind) {
+        case Kind::Join:
+            request_.method(http::verb::post);
+            request_.target("/api/v1/game/join"sv);
+            request_.set(http::field::content_type, "application/json"sv);
+            request_.body() = R"({"userName":")"s + name_ + R"(","mapId":")"s + map_id_ + "\"}"s;
+            break;
+        case Kind::Action: {
+            std::uniform_int_distribution<std::size_t> move(0, kMoves.size() - 1);
+            request_.method(http::verb::post);
+            request_.target("/api/v1/game/player/action"sv);
+            request_.set(http::field::content_type, "application/json"sv);
+            request_.body() = R"({"move":")"s + std::string{kMoves[move(random_)]} + "\"}"s;
+            break;
+        }
+        case Kind::State:
+            request_.method(http::verb::get);
+            request_.target("/api/v1/game/state"sv);
+            break;
+        case Kind::Players:
+            request_.method(http::verb::get);
+            request_.target("/api/v1/game/players"sv);
+            break;
+    }
+    if (kind != Kind::Join) {
+        request_.set(http::field::authorization, "Bearer "s + token_);
+    }
+    request_.prepare_payload();
+}
+
+void Bot::Connect() {
+    stream_.expires_after(swarm_.Options().timeout);
+    stream_.async_connect(swarm_.Endpoints(), [self = shared_from_this()](
+                                                  sys::error_code ec, const tcp::endpoint&) {
+        if (ec) {
+            self->OnResponse(ec);
+            return;
+        }
+        self->stream_.socket().set_option(tcp::no_delay{true});
+        self->Write();
+    });
+}
+
+void Bot::Write() {
+    stream_.expires_after(swarm_.Options().timeout);
+    http::async_write(stream_, request_,
+                      [self = shared_from_this()](sys::error_code ec, std::size_t) {
+                          if (ec) {
+                              self->OnResponse(ec);
+                              return;
+                          }
+                          self->Read();
+                      });
+}
+
+void Bot::Read() {
+    response_ = {};
+    http::async_read(stream_, buffer_, response_,
+                     [self = shared_from_this()](sys::error_code ec, std::size_t) {
+                         self->OnResponse(ec);
+                     });
+}
+
+void Bot::OnResponse(sys::error_code ec) {
+    if (stopped_) {
+        return;
+    }
+    const Pending done = *current_;
+    current_.reset();
+    pending_[Index(done.kind)] = false;
+
+    const bool ok = !ec && response_.result() == http::status::ok;
+    swarm_.Stats().Record(done.kind, Clock::now() - done.scheduled, ok);
+
+    // После ошибки соединение открывается заново
+    if (ec || !response_.keep_alive()) {
+        stream_.close();
+        buffer_.clear();
+    }
+
+    if (done.kind == Kind::Join) {
+        OnJoined(ok);
+    }
+    SendNext();
+}
+
+void Bot::OnJoined(bool ok) {
+    if (ok) {
+        auto tokens = FindJsonStrings(response_.body(), "authToken"sv);
+        if (!tokens.empty()) {
+            token_ = std::move(tokens.front());
+            swarm_.OnBotJoined();
+
+            // Случайная фаза, чтобы боты, вошедшие одновременно, не опрашивали сервер залпом
+            const auto now = Clock::now();
+            std::uniform_real_distribution<double> phase(0.0, 1.0);
+            if (swarm_.Options().state_rate > 0) {
+                next_state_ = now + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(
+                                            phase(random_) / swarm_.Options().state_rate));
+                ScheduleState();
+            }
+            if (swarm_.Options().action_rate > 0) {
+                next_action_ = now;
+                ScheduleAction();
+            }
+            return;
+        }
+    }
+
+    state_timer_.expires_after(kJoinRetryDelay);
+    state_timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
+        if (!ec) {
+            self->Enqueue(Kind::Join, Clock::now());
+        }
+    });
+}
+
+// Опрос состояния идёт с постоянной частотой по абсолютному расписанию
+void Bot::ScheduleState() {
+    state_timer_.expires_at(next_state_);
+    state_timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
+        if (ec || self->stopped_) {
+            return;
+        }
+        const auto& options = self->swarm_.Options();
+        self->Enqueue(Kind::State, self->next_state_);
+        if (options.players_every > 0 && ++self->polls_ % options.players_every == 0) {
+            self->Enqueue(Kind::Players, self->next_state_);
+        }
+        self->next_state_ += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / options.state_rate));
+        self->ScheduleState();
+    });
+}
+
+// Нажатия клавиш - пуассоновский поток со средней частотой action_rate
+void Bot::ScheduleAction() {
+    std::exponential_distribution<double> gap(swarm_.Options().action_rate);
+    next_action_ += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(gap(random_)));
+    action_timer_.expires_at(next_action_);
+    action_timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
+        if (ec || self->stopped_) {
+            return;
+        }
+        self->Enqueue(Kind::Action, self->next_action_);
+        self->ScheduleAction();
+    });
+}
+
+std::vector<std::string> FetchMapIds(net::io_context& ioc,
+                                     const tcp::resolver::results_type& endpoints,
+                                     const std::string& host) {
+    beast::tcp_stream stream{ioc};
+    stream.connect(endpoints);
+
+    http::request<http::empty_body> request{http::verb::get, "/api/v1/maps", 11};
+    request.set(http::field::host, host);
+    http::write(stream, request);
+
+    beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+    if (response.result() != http::status::ok) {
+        throw std::runtime_error("GET /api/v1/maps failed with status "s +
+                                 std::to_string(response.result_int()));
+    }
+    auto ids = FindJsonStrings(response.body(), "id"sv);
+    if (ids.empty()) {
+        throw std::runtime_error("Server has no maps"s);
+    }
+    return ids;
+}
+
+}  // namespace
+
+void RunSwarm(const SwarmOptions& options, std::ostream& out) {
+    net::io_context ioc{static_cast<int>(std::max(1u, options.threads))};
+    tcp::resolver resolver{ioc};
+    auto endpoints = resolver.resolve(options.host, options.port);
+
+    auto maps = options.maps.empty() ? FetchMapIds(ioc, endpoints, options.host) : options.maps;
+
+    Swarm swarm{ioc, options, std::move(endpoints), std::move(maps), out};
+    swarm.Start();
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned i = 1; i < options.threads; ++i) {
+            workers.emplace_back([&ioc] { ioc.run(); });
+        }
+        ioc.run();
+    }
+    swarm.PrintTotal();
+}
+
+}  // namespace load
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace load {
+
+struct SwarmOptions {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    std::size_t bots = 100;
+    // Игроки подключаются равномерно в течение ramp, поэтому отчёт за каждый интервал
+    // показывает, как растёт задержка с числом игроков
+    std::chrono::seconds ramp{30};
+    std::chrono::seconds duration{60};
+    // Частоты на одного бота, в секунду
+    double state_rate = 10.0;
+    double action_rate = 1.0;
+    // Список игроков запрашивается после каждых players_every опросов состояния, как в game.js
+    unsigned players_every = 50;
+    // Пусто - боты распределяются по всем картам из /api/v1/maps
+    std::vector<std::string> maps;
+    unsigned threads = 2;
+    std::chrono::milliseconds timeout{5000};
+    std::chrono::seconds report_interval{5};
+};
+
+// Запускает ботов, каждый из которых ведёт себя как вкладка с game.js: входит в игру через
+// /api/v1/game/join, опрашивает /game/state и /game/players и случайно меняет направление
+// через /game/player/action. У каждого бота своё keep-alive соединение.
+// Каждые report_interval в out выводится строка с числом ботов, rps и задержками по типам
+// запросов, в конце - итог за весь прогон. SIGINT завершает прогон досрочно.
+void RunSwarm(const SwarmOptions& options, std::ostream& out);
+
+}  // namespace load
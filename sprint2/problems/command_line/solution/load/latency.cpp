@@ -0,0 +1,46 @@
+#include "latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace load {
+
+namespace {
+
+std::uint32_t Percentile(const std::vector<std::uint32_t>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+}  // namespace
+
+void LatencySample::Add(std::chrono::nanoseconds latency) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    latencies_us_.push_back(
+        static_cast<std::uint32_t>(std::clamp<std::int64_t>(us, 0, UINT32_MAX)));
+}
+
+void LatencySample::Append(const LatencySample& other) {
+    latencies_us_.insert(latencies_us_.end(), other.latencies_us_.begin(),
+                         other.latencies_us_.end());
+}
+
+LatencySample::Summary LatencySample::Summarize() const {
+    auto sorted = latencies_us_;
+    std::sort(sorted.begin(), sorted.end());
+    return {sorted.size(), Percentile(sorted, 0.5), Percentile(sorted, 0.99),
+            Percentile(sorted, 0.999), sorted.empty() ? 0 : sorted.back()};
+}
+
+std::string FormatMs(std::uint32_t us) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(us < 10'000 ? 2 : 1) << us / 1000.0 << " ms";
+    return out.str();
+}
+
+}  // namespace load
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace load {
+
+// Задержки всех запросов с точностью до микросекунды. Хранятся целиком, поэтому перцентили
+// точные, а не оценка по корзинам
+class LatencySample {
+   public:
+    struct Summary {
+        std::size_t count = 0;
+        std::uint32_t p50 = 0;
+        std::uint32_t p99 = 0;
+        std::uint32_t p999 = 0;
+        std::uint32_t max = 0;
+    };
+
+    void Add(std::chrono::nanoseconds latency);
+    void Append(const LatencySample& other);
+
+    std::size_t Count() const noexcept { return latencies_us_.size(); }
+    Summary Summarize() const;
+
+   private:
+    std::vector<std::uint32_t> latencies_us_;
+};
+
+// "0.42 ms", "12.3 ms"
+std::string FormatMs(std::uint32_t us);
+
+}  // namespace load
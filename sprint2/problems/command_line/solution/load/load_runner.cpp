@@ -0,0 +1,319 @@
+#include "load_runner.h"
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <algorithm>
+#include <csignal>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <optional>
+
+namespace load {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace sys = boost::system;
+using net::ip::tcp;
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Outcome {
+    Clock::time_point scheduled{};
+    unsigned status = 0;  // 0 - ответ не получен, причина в error
+    sys::error_code error{};
+};
+
+class Runner;
+
+// Соединение с сервером, по которому запросы идут строго по одному
+class Connection : public std::enable_shared_from_this<Connection> {
+   public:
+    Connection(net::io_context& ioc, Runner& runner) : stream_{ioc}, runner_{runner} {}
+
+    void Send(const Shot& shot, Clock::time_point scheduled);
+
+   private:
+    void Connect();
+    void Write();
+    void Read();
+    void Complete(sys::error_code ec);
+
+    beast::tcp_stream stream_;
+    Runner& runner_;
+    beast::flat_buffer buffer_;
+    http::request<http::empty_body> request_;
+    http::response<http::string_body> response_;
+    Clock::time_point scheduled_;
+};
+
+class Runner {
+   public:
+    Runner(net::io_context& ioc, const std::vector<Shot>& ammo, Schedule schedule,
+           const RunOptions& options, tcp::resolver::results_type endpoints)
+        : ioc_{ioc},
+          ammo_{ammo},
+          schedule_{std::move(schedule)},
+          options_{options},
+          endpoints_{std::move(endpoints)} {}
+
+    void Start() {
+        signals_.async_wait([this](sys::error_code ec, int) {
+            if (!ec) {
+                Stop();
+            }
+        });
+        start_ = Clock::now();
+        next_ = schedule_.Next();
+        ScheduleNext();
+    }
+
+    Report TakeReport() { return std::move(report_); }
+
+    const tcp::resolver::results_type& Endpoints() const { return endpoints_; }
+    std::chrono::milliseconds Timeout() const { return options_.timeout; }
+
+    const std::string& Host() const { return options_.host; }
+
+    void OnConnect() { ++report_.connections_opened; }
+
+    void OnComplete(std::shared_ptr<Connection> connection, const Outcome& outcome) {
+        Record(outcome);
+
+        if (!queue_.empty()) {
+            const auto [shot, scheduled] = queue_.front();
+            queue_.pop_front();
+            connection->Send(*shot, scheduled);
+            return;
+        }
+        --in_flight_;
+        idle_.push_back(std::move(connection));
+        MaybeFinish();
+    }
+
+   private:
+    void ScheduleNext() {
+        if (!next_) {
+            MaybeFinish();
+            return;
+        }
+        timer_.expires_at(start_ + *next_);
+        timer_.async_wait([this](sys::error_code ec) {
+            if (!ec) {
+                OnTimer();
+            }
+        });
+    }
+
+    // Отправляет все запросы, чьё время наступило. Если поток генератора не успевал,
+    // запросы уходят пачкой, но с прежним запланированным временем
+    void OnTimer() {
+        const auto now = Clock::now();
+        while (next_ && start_ + *next_ <= now) {
+            Fire(start_ + *next_);
+            next_ = schedule_.Next();
+        }
+        ScheduleNext();
+    }
+
+    void Fire(Clock::time_point scheduled) {
+        ++report_.planned;
+        const Shot& shot = ammo_[ammo_index_];
+        ammo_index_ = (ammo_index_ + 1) % ammo_.size();
+
+        std::shared_ptr<Connection> connection;
+        if (!idle_.empty()) {
+            connection = std::move(idle_.back());
+            idle_.pop_back();
+        } else if (connections_ < options_.max_connections) {
+            connection = std::make_shared<Connection>(ioc_, *this);
+            ++connections_;
+        } else {
+            queue_.emplace_back(&shot, scheduled);
+            report_.max_queue = std::max(report_.max_queue, queue_.size());
+            return;
+        }
+        ++in_flight_;
+        connection->Send(shot, scheduled);
+    }
+
+    void Record(const Outcome& outcome) {
+        ++report_.completed;
+        report_.latency.Add(Clock::now() - outcome.scheduled);
+
+        if (outcome.status >= 100 && outcome.status < 600) {
+            ++report_.status_classes[outcome.status / 100 - 1];
+        } else {
+            ++report_.network_errors[outcome.error ? outcome.error.message() : "bad status"s];
+        }
+    }
+
+    // SIGINT: новые запросы не отправляются, отправленные дожидаются ответа
+    void Stop() {
+        next_.reset();
+        timer_.cancel();
+        report_.planned -= queue_.size();
+        queue_.clear();
+        MaybeFinish();
+    }
+
+    void MaybeFinish() {
+        if (next_ || in_flight_ > 0 || finished_) {
+            return;
+        }
+        finished_ = true;
+        report_.elapsed = Clock::now() - start_;
+        // Без ожидающих операций io_context::run вернёт управление
+        signals_.cancel();
+        idle_.clear();
+    }
+
+    net::io_context& ioc_;
+    const std::vector<Shot>& ammo_;
+    Schedule schedule_;
+    const RunOptions& options_;
+    tcp::resolver::results_type endpoints_;
+    net::steady_timer timer_{ioc_};
+    net::signal_set signals_{ioc_, SIGINT};
+
+    Clock::time_point start_;
+    std::optional<Schedule::Duration> next_;
+    std::size_t ammo_index_ = 0;
+
+    std::vector<std::shared_ptr<Connection>> idle_;
+    std::deque<std::pair<const Shot*, Clock::time_point>> queue_;
+    std::size_t connections_ = 0;
+    std::size_t in_flight_ = 0;
+    bool finished_ = false;
+
+    Report report_;
+};
+
+void Connection::Send(const Shot& shot, Clock::time_point scheduled) {
+    scheduled_ = scheduled;
+
+    request_ = {};
+    request_.method(http::verb::get);
+    request_.target(shot.uri);
+    request_.version(11);
+    for (const auto& [name, value] : shot.headers) {
+        request_.set(name, value);
+    }
+    if (request_.find(http::field::host) == request_.end()) {
+        request_.set(http::field::host, runner_.Host());
+    }
+
+    if (stream_.socket().is_open()) {
+        Write();
+    } else {
+        Connect();
+    }
+}
+
+void Connection::Connect() {
+    stream_.expires_after(runner_.Timeout());
+    stream_.async_connect(runner_.Endpoints(), [self = shared_from_this()](
+                                                   sys::error_code ec, const tcp::endpoint&) {
+        if (ec) {
+            self->Complete(ec);
+            return;
+        }
+        self->stream_.socket().set_option(tcp::no_delay{true});
+        self->runner_.OnConnect();
+        self->Write();
+    });
+}
+
+void Connection::Write() {
+    stream_.expires_after(runner_.Timeout());
+    http::async_write(stream_, request_,
+                      [self = shared_from_this()](sys::error_code ec, std::size_t) {
+                          if (ec) {
+                              self->Complete(ec);
+                              return;
+                          }
+                          self->Read();
+                      });
+}
+
+void Connection::Read() {
+    response_ = {};
+    http::async_read(stream_, buffer_, response_,
+                     [self = shared_from_this()](sys::error_code ec, std::size_t) {
+                         self->Complete(ec);
+                     });
+}
+
+void Connection::Complete(sys::error_code ec) {
+    Outcome outcome{scheduled_};
+    if (ec) {
+        outcome.error = ec;
+    } else {
+        outcome.status = response_.result_int();
+    }
+
+    // После ошибки или "Connection: close" следующий запрос откроет новое соединение
+    if (ec || !response_.keep_alive()) {
+        sys::error_code ignored;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ignored);
+        stream_.close();
+        buffer_.clear();
+    }
+    runner_.OnComplete(shared_from_this(), outcome);
+}
+
+}  // namespace
+
+std::uint64_t Report::Errors() const {
+    std::uint64_t errors = status_classes[4];
+    for (const auto& [message, count] : network_errors) {
+        errors += count;
+    }
+    return errors;
+}
+
+void Report::Print(std::ostream& out) const {
+    const auto summary = latency.Summarize();
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    const double rps = seconds > 0 ? static_cast<double>(completed) / seconds : 0.0;
+    const double error_rate =
+        planned > 0 ? 100.0 * static_cast<double>(Errors()) / static_cast<double>(planned) : 0.0;
+
+    out << std::fixed << std::setprecision(1);
+    out << "Requests:    " << planned << " sent, " << completed << " completed in " << seconds
+        << " s (" << rps << " rps)\n";
+    out << "Latency:     p50 " << FormatMs(summary.p50) << ", p99 " << FormatMs(summary.p99)
+        << ", p99.9 " << FormatMs(summary.p999) << ", max " << FormatMs(summary.max) << '\n';
+    out << "Responses:  ";
+    for (std::size_t i = 0; i < status_classes.size(); ++i) {
+        out << (i > 0 ? ", " : " ") << i + 1 << "xx " << status_classes[i];
+    }
+    out << '\n';
+    out << std::setprecision(2) << "Errors:      " << Errors() << " (" << error_rate
+        << "%: 5xx and requests without response)\n";
+    for (const auto& [message, count] : network_errors) {
+        out << "  " << message << ": " << count << '\n';
+    }
+    out << "Connections: " << connections_opened << " opened, max queue " << max_queue << '\n';
+}
+
+Report Run(const std::vector<Shot>& ammo, Schedule schedule, const RunOptions& options) {
+    net::io_context ioc{1};
+    tcp::resolver resolver{ioc};
+    auto endpoints = resolver.resolve(options.host, options.port);
+
+    Runner runner{ioc, ammo, std::move(schedule), options, std::move(endpoints)};
+    runner.Start();
+    ioc.run();
+    return runner.TakeReport();
+}
+
+}  // namespace load
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "ammo.h"
+#include "latency.h"
+#include "schedule.h"
+
+namespace load {
+
+struct RunOptions {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    // Больше соединений не открывается: запросы сверх этого ждут в очереди генератора,
+    // и ожидание входит в их задержку
+    std::size_t max_connections = 256;
+    std::chrono::milliseconds timeout{5000};
+};
+
+struct Report {
+    std::uint64_t planned = 0;
+    std::uint64_t completed = 0;
+    // Ответы по классам 1xx .. 5xx
+    std::array<std::uint64_t, 5> status_classes{};
+    // Запросы без ответа: ошибка соединения, таймаут и т.п.
+    std::map<std::string, std::uint64_t> network_errors;
+    // Задержки завершённых запросов от запланированного момента отправки
+    LatencySample latency;
+    std::chrono::nanoseconds elapsed{};
+    std::uint64_t connections_opened = 0;
+    std::size_t max_queue = 0;
+
+    std::uint64_t Errors() const;
+    void Print(std::ostream& out) const;
+};
+
+// Отправляет запросы из ammo по кругу в моменты, заданные schedule, и ждёт ответы на все.
+// Задержка отсчитывается от запланированного момента отправки, а не от фактического, поэтому
+// перегруженный сервер (или генератор) не прячет своё время ответа: нет coordinated omission.
+// Работает в вызывающем потоке; SIGINT досрочно прекращает отправку.
+Report Run(const std::vector<Shot>& ammo, Schedule schedule, const RunOptions& options);
+
+}  // namespace load
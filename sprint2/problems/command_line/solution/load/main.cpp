@@ -0,0 +1,136 @@
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ammo.h"
+#include "bot_swarm.h"
+#include "load_runner.h"
+#include "schedule.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct Args {
+    std::string ammo_file;
+    std::string schedule = "line(5, 30, 1m)";
+    std::string address = "127.0.0.1:8080";
+    std::size_t connections = 256;
+    int timeout_ms = 5000;
+
+    // Режим ботов: вместо обстрела патронами
+    std::size_t bots = 0;
+    int ramp_s = 30;
+    int duration_s = 60;
+    double state_rate = 10.0;
+    double action_rate = 1.0;
+    unsigned threads = 2;
+    std::vector<std::string> maps;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* argv[]) {
+    namespace po = boost::program_options;
+
+    Args args;
+
+    po::options_description desc{"Allowed options"s};
+    desc.add_options()("help,h", "produce help message")(
+        "ammo,a", po::value(&args.ammo_file)->value_name("file"), "phantom uri ammo file")(
+        "schedule,s", po::value(&args.schedule)->value_name("profile"),
+        "load profile, e.g. \"line(5, 30, 1m) const(30, 2m)\"")(
+        "address", po::value(&args.address)->value_name("host:port"), "server address")(
+        "connections", po::value(&args.connections)->value_name("n"),
+        "max simultaneous connections")(
+        "timeout", po::value(&args.timeout_ms)->value_name("milliseconds"), "request timeout");
+
+    po::options_description bots_desc{"Bot swarm (instead of ammo)"s};
+    bots_desc.add_options()(
+        "bots", po::value(&args.bots)->value_name("n"), "number of players to join")(
+        "ramp", po::value(&args.ramp_s)->value_name("seconds"), "time to join all players")(
+        "duration", po::value(&args.duration_s)->value_name("seconds"), "test duration")(
+        "state-rate", po::value(&args.state_rate)->value_name("hz"),
+        "game state polls per second per player")(
+        "action-rate", po::value(&args.action_rate)->value_name("hz"),
+        "moves per second per player")(
+        "threads", po::value(&args.threads)->value_name("n"), "client threads")(
+        "map", po::value(&args.maps)->value_name("id"),
+        "map to join, may be repeated (default: all maps)");
+    desc.add(bots_desc);
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cerr << desc;
+        return std::nullopt;
+    }
+    if (args.bots == 0 && !vm.contains("ammo"s)) {
+        throw std::runtime_error("Either ammo file or number of bots must be specified"s);
+    }
+    if (args.ramp_s < 0 || args.duration_s <= 0 || args.state_rate < 0 || args.action_rate < 0) {
+        throw std::runtime_error("Bot swarm timings and rates must not be negative"s);
+    }
+    if (args.connections == 0 || args.timeout_ms <= 0) {
+        throw std::runtime_error("Connections and timeout must be positive"s);
+    }
+
+    return args;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        if (auto args = ParseCommandLine(argc, argv)) {
+            const auto colon = args->address.rfind(':');
+            if (colon == std::string::npos) {
+                throw std::runtime_error("Address must be host:port"s);
+            }
+
+            if (args->bots > 0) {
+                load::SwarmOptions options;
+                options.host = args->address.substr(0, colon);
+                options.port = args->address.substr(colon + 1);
+                options.bots = args->bots;
+                options.ramp = std::chrono::seconds{args->ramp_s};
+                options.duration = std::chrono::seconds{args->duration_s};
+                options.state_rate = args->state_rate;
+                options.action_rate = args->action_rate;
+                options.threads = args->threads;
+                options.maps = args->maps;
+                options.timeout = std::chrono::milliseconds{args->timeout_ms};
+
+                load::RunSwarm(options, std::cout);
+                return EXIT_SUCCESS;
+            }
+
+            const auto ammo = load::ReadAmmo(args->ammo_file);
+            auto schedule = load::Schedule::Parse(args->schedule);
+
+            load::RunOptions options;
+            options.host = args->address.substr(0, colon);
+            options.port = args->address.substr(colon + 1);
+            options.max_connections = args->connections;
+            options.timeout = std::chrono::milliseconds{args->timeout_ms};
+
+            std::cerr << "Shooting " << schedule.TotalShots() << " requests over "
+                      << std::chrono::duration_cast<std::chrono::seconds>(
+                             schedule.TotalDuration())
+                             .count()
+                      << " s at " << args->address << '\n';
+
+            const auto report = load::Run(ammo, std::move(schedule), options);
+            report.Print(std::cout);
+        }
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
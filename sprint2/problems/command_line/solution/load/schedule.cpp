@@ -0,0 +1,166 @@
+#include "schedule.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace load {
+
+using namespace std::literals;
+
+namespace {
+
+std::string_view TrimSpaces(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+double ParseNumber(std::string_view text) {
+    const std::string s{TrimSpaces(text)};
+    std::size_t parsed = 0;
+    double value = 0.0;
+    try {
+        value = std::stod(s, &parsed);
+    } catch (const std::exception&) {
+        parsed = 0;
+    }
+    if (s.empty() || parsed != s.size() || !std::isfinite(value) || value < 0.0) {
+        throw std::invalid_argument("Invalid number in load profile: "s + s);
+    }
+    return value;
+}
+
+// "1m", "30s", "500ms", "2h", "45"
+double ParseSeconds(std::string_view text) {
+    text = TrimSpaces(text);
+    double scale = 1.0;
+    if (text.ends_with("ms"sv)) {
+        scale = 0.001;
+        text.remove_suffix(2);
+    } else if (text.ends_with('s')) {
+        text.remove_suffix(1);
+    } else if (text.ends_with('m')) {
+        scale = 60.0;
+        text.remove_suffix(1);
+    } else if (text.ends_with('h')) {
+        scale = 3600.0;
+        text.remove_suffix(1);
+    }
+    const double seconds = ParseNumber(text) * scale;
+    if (seconds <= 0.0) {
+        throw std::invalid_argument("Load profile duration must be positive"s);
+    }
+    return seconds;
+}
+
+std::vector<std::string_view> SplitArgs(std::string_view args) {
+    std::vector<std::string_view> result;
+    for (;;) {
+        const auto comma = args.find(',');
+        result.push_back(TrimSpaces(args.substr(0, comma)));
+        if (comma == std::string_view::npos) {
+            return result;
+        }
+        args.remove_prefix(comma + 1);
+    }
+}
+
+}  // namespace
+
+Schedule Schedule::Parse(std::string_view text) {
+    std::vector<Segment> segments;
+
+    text = TrimSpaces(text);
+    while (!text.empty()) {
+        const auto open = text.find('(');
+        const auto close = text.find(')');
+        if (open == std::string_view::npos || close == std::string_view::npos || close < open) {
+            throw std::invalid_argument("Invalid load profile: "s + std::string{text});
+        }
+        const auto name = TrimSpaces(text.substr(0, open));
+        const auto args = SplitArgs(text.substr(open + 1, close - open - 1));
+
+        if (name == "line"sv && args.size() == 3) {
+            segments.push_back({ParseNumber(args[0]), ParseNumber(args[1]), ParseSeconds(args[2])});
+        } else if (name == "const"sv && args.size() == 2) {
+            const double rps = ParseNumber(args[0]);
+            segments.push_back({rps, rps, ParseSeconds(args[1])});
+        } else if (name == "step"sv && args.size() == 4) {
+            const double from = ParseNumber(args[0]);
+            const double to = ParseNumber(args[1]);
+            const double step = ParseNumber(args[2]);
+            const double seconds = ParseSeconds(args[3]);
+            if (step <= 0.0 || to < from) {
+                throw std::invalid_argument("Invalid step() in load profile"s);
+            }
+            for (double rps = from; rps <= to + 1e-9; rps += step) {
+                segments.push_back({rps, rps, seconds});
+            }
+        } else {
+            throw std::invalid_argument("Unknown load profile segment: "s +
+                                        std::string{text.substr(0, close + 1)});
+        }
+
+        text = TrimSpaces(text.substr(close + 1));
+    }
+
+    if (segments.empty()) {
+        throw std::invalid_argument("Empty load profile"s);
+    }
+    return Schedule{std::move(segments)};
+}
+
+double Schedule::ShotTime(const Segment& segment, std::uint64_t k) {
+    const double a = segment.from_rps;
+    const double slope = (segment.to_rps - segment.from_rps) / segment.seconds;
+    if (std::abs(slope) < 1e-12) {
+        return static_cast<double>(k) / a;
+    }
+    const double discriminant = std::max(0.0, a * a + 2.0 * slope * static_cast<double>(k));
+    return (std::sqrt(discriminant) - a) / slope;
+}
+
+std::uint64_t Schedule::ShotCount(const Segment& segment) {
+    // Площадь под графиком частоты; первый запрос участка уходит в момент 0
+    const double shots = (segment.from_rps + segment.to_rps) / 2.0 * segment.seconds;
+    return shots <= 0.0 ? 0 : static_cast<std::uint64_t>(std::ceil(shots - 1e-9));
+}
+
+std::optional<Schedule::Duration> Schedule::Next() {
+    while (segment_ < segments_.size()) {
+        const Segment& segment = segments_[segment_];
+        if (shot_ < ShotCount(segment)) {
+            const double seconds = segment_start_ + ShotTime(segment, shot_++);
+            return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(seconds));
+        }
+        segment_start_ += segment.seconds;
+        shot_ = 0;
+        ++segment_;
+    }
+    return std::nullopt;
+}
+
+Schedule::Duration Schedule::TotalDuration() const {
+    double seconds = 0.0;
+    for (const Segment& segment : segments_) {
+        seconds += segment.seconds;
+    }
+    return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(seconds));
+}
+
+std::uint64_t Schedule::TotalShots() const {
+    std::uint64_t shots = 0;
+    for (const Segment& segment : segments_) {
+        shots += ShotCount(segment);
+    }
+    return shots;
+}
+
+}  // namespace load
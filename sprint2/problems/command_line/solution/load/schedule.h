@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace load {
+
+// Профиль нагрузки в синтаксисе yandex-tank. Участки выполняются друг за другом:
+//   line(a, b, dur)        частота растёт линейно от a до b rps
+//   const(r, dur)          постоянная частота
+//   step(a, b, s, dur)     ступени a, a + s, ... до b включительно, каждая длиной dur
+// Длительность задаётся числом с единицей ms, s, m или h (без единицы - секунды).
+//
+// Моменты отправки вычисляются заранее по профилю и не зависят от того, как быстро отвечает
+// сервер (открытая модель нагрузки).
+class Schedule {
+   public:
+    using Duration = std::chrono::nanoseconds;
+
+    // Выбрасывает std::invalid_argument, если профиль задан неверно
+    static Schedule Parse(std::string_view text);
+
+    // Момент отправки очередного запроса от начала теста; nullopt, когда профиль закончился
+    std::optional<Duration> Next();
+
+    Duration TotalDuration() const;
+    std::uint64_t TotalShots() const;
+
+   private:
+    struct Segment {
+        double from_rps;
+        double to_rps;
+        double seconds;
+    };
+
+    explicit Schedule(std::vector<Segment> segments) : segments_{std::move(segments)} {}
+
+    // Время k-го запроса от начала участка: решение a*t + (b - a)*t^2 / (2T) = k
+    static double ShotTime(const Segment& segment, std::uint64_t k);
+    static std::uint64_t ShotCount(const Segment& segment);
+
+    std::vector<Segment> segments_;
+    std::size_t segment_ = 0;
+    std::uint64_t shot_ = 0;
+    double segment_start_ = 0.0;
+};
+
+}  // namespace load
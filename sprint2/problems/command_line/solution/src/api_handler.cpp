@@ -3,45 +3,20 @@
 #include <chrono>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
+#include "auth.h"
 #include "boost/json/object.hpp"
 #include "http_response.h"
 #include "json_keys.h"
 #include "json_serializer.h"
 #include "model.h"
+#include "tracing.h"
 #include "url_utils.h"
 
 namespace http_handler {
 namespace json = boost::json;
 namespace {
-inline bool IsHex(char c) {
-    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-}
-
-inline bool IsValidTokenFormat(std::string_view token) {
-    if (token.size() != 32) return false;
-    for (char c : token) {
-        if (!IsHex(c)) return false;
-    }
-    return true;
-}
-
-inline std::optional<std::string_view> ExtractBearerToken(const http::fields& headers) {
-    auto it = headers.find(http::field::authorization);
-    if (it == headers.end()) return std::nullopt;
-
-    std::string_view v = it->value();
-    constexpr std::string_view kPrefix = "Bearer "sv;
-    if (!v.starts_with(kPrefix)) return std::nullopt;
-
-    v.remove_prefix(kPrefix.size());
-    if (v.empty()) return std::nullopt;
-
-    return v;
-}
-
-using PlayersIds = std::vector<int>;
-
 inline StringResponse MethodNotAllowed(unsigned version, bool keep_alive, std::string_view allow,
                                        std::string_view msg = "Invalid method"sv) {
     auto resp = MakeJsonError(http::status::method_not_allowed, "invalidMethod"sv, msg, version,
@@ -51,8 +26,8 @@ inline StringResponse MethodNotAllowed(unsigned version, bool keep_alive, std::s
 }
 
 template <class Fn>
-StringResponse ExecuteIfGetOrHead(http::verb method, unsigned version, bool keep_alive,
-                                  Fn&& action) {
+std::invoke_result_t<Fn> ExecuteIfGetOrHead(http::verb method, unsigned version, bool keep_alive,
+                                            Fn&& action) {
     if (method != http::verb::get && method != http::verb::head) {
         return MethodNotAllowed(version, keep_alive, "GET, HEAD"sv, "Invalid method"sv);
     }
@@ -60,42 +35,81 @@ StringResponse ExecuteIfGetOrHead(http::verb method, unsigned version, bool keep
 }
 
 template <class Fn>
-StringResponse ExecuteAuthorized(const http::fields& headers, unsigned version, bool keep_alive,
-                                 app::Application& app, Fn&& action) {
-    auto token = ExtractBearerToken(headers);
-    if (!token) {
-        return MakeJsonError(http::status::unauthorized, "invalidToken"sv,
-                             "Authorization header is missing"sv, version, keep_alive);
+std::invoke_result_t<Fn, model::Player&> ExecuteAuthorized(const Fields& headers,
+                                                           unsigned version, bool keep_alive,
+                                                           app::Application& app, Fn&& action) {
+    model::Player* player = nullptr;
+    {
+        app_tracing::Span span{"api.authorize"};
+        auto token = ExtractBearerToken(headers);
+        if (!token) {
+            return MakeJsonError(http::status::unauthorized, "invalidToken"sv,
+                                 "Authorization header is missing"sv, version, keep_alive);
+        }
+
+        std::string_view token_sv = *token;
+        if (!IsValidTokenFormat(token_sv)) {
+            return MakeJsonError(http::status::unauthorized, "invalidToken"sv, "Invalid token"sv,
+                                 version, keep_alive);
+        }
+
+        player = app.Authorize(token_sv);
+        if (!player) {
+            return MakeJsonError(http::status::unauthorized, "unknownToken"sv,
+                                 "Player token has not been found"sv, version, keep_alive);
+        }
     }
 
-    std::string_view token_sv = *token;
-    if (!IsValidTokenFormat(token_sv)) {
-        return MakeJsonError(http::status::unauthorized, "invalidToken"sv, "Invalid token"sv,
-                             version, keep_alive);
-    }
+    return std::forward<Fn>(action)(*player);
+}
 
-    auto players = app.GetPlayers(token_sv);
-    if (!players) {
-        return MakeJsonError(http::status::unauthorized, "unknownToken"sv,
-                             "Player token has not been found"sv, version, keep_alive);
+// Ответ с телом из опубликованного снимка сессии в формате, выбранном по Accept
+ApiResponse MakeSnapshotResponse(http::verb method, const model::EncodedBody& json,
+                                 const model::EncodedBody& binary, const Fields& headers,
+                                 unsigned version, bool keep_alive) {
+    const bool use_binary = SelectEncoding(headers) == BodyEncoding::Binary;
+    const model::EncodedBody& body = use_binary ? binary : json;
+    const std::string_view content_type = use_binary ? ContentType::GAME_BINARY : ContentType::JSON;
+
+    if (MatchesIfNoneMatch(headers, body.etag)) {
+        auto response = MakeNotModified(body.etag, version, keep_alive);
+        response.set(http::field::vary, "Accept"sv);
+        return response;
     }
-
-    return std::forward<Fn>(action)(token_sv, *players);
+    if (method == http::verb::head) {
+        auto response = MakeStringResponse(http::status::ok, ""sv, version, keep_alive, content_type);
+        response.set(http::field::etag, body.etag);
+        response.set(http::field::vary, "Accept"sv);
+        return response;
+    }
+    auto response =
+        MakeSharedResponse(http::status::ok, body.data, version, keep_alive, content_type, body.etag);
+    response.set(http::field::vary, "Accept"sv);
+    return response;
 }
 
 }  // namespace
 
-StringResponse ApiHandler::HandleImpl(http::verb method, std::string_view target,
-                                      std::string_view body, const http::fields& headers,
-                                      unsigned version, bool keep_alive) {
+bool ApiHandler::IsConcurrentRead(http::verb method, std::string_view target) noexcept {
+    if (method != http::verb::get && method != http::verb::head) {
+        return false;
+    }
+    return target == Endpoint::STATE || target == Endpoint::PLAYERS ||
+           target.starts_with(Endpoint::MAPS);
+}
+
+ApiResponse ApiHandler::HandleImpl(http::verb method, std::string_view target,
+                                   std::string_view body, const Fields& headers,
+                                   unsigned version, bool keep_alive) {
+    app_tracing::Span span{"api.handle"};
     if (target == Endpoint::JOIN) {
         return HandleJoinRequest(method, body, headers, version, keep_alive);
     }
     if (target == Endpoint::MAPS) {
-        return HandleMapsRequest(version, keep_alive);
+        return HandleMapsRequest(headers, version, keep_alive);
     }
     if (target.starts_with(Endpoint::MAPS)) {
-        return HandleMapDataRequest(target, version, keep_alive);
+        return HandleMapDataRequest(target, headers, version, keep_alive);
     }
     if (target == Endpoint::PLAYERS) {
         return HandlePlayersRequest(method, headers, version, keep_alive);
@@ -115,8 +129,9 @@ StringResponse ApiHandler::HandleImpl(http::verb method, std::string_view target
 }
 
 StringResponse ApiHandler::HandleJoinRequest(http::verb method, std::string_view body,
-                                             const http::fields& headers, unsigned version,
+                                             const Fields& headers, unsigned version,
                                              bool keep_alive) {
+    app_tracing::Span span{"api.join"};
     if (method != http::verb::post) {
         auto response = MakeJsonError(http::status::method_not_allowed, "invalidMethod"sv,
                                       "Only POST method is expected"sv, version, keep_alive);
@@ -142,6 +157,7 @@ StringResponse ApiHandler::HandleJoinRequest(http::verb method, std::string_view
 
     boost::json::value parsed;
     try {
+        app_tracing::Span parse_span{"api.parse"};
         parsed = boost::json::parse(boost::json::string_view(body.data(), body.size()));
     } catch (...) {
         return MakeJsonError(http::status::bad_request, "invalidArgument"sv,
@@ -172,6 +188,7 @@ StringResponse ApiHandler::HandleJoinRequest(http::verb method, std::string_view
     try {
         auto result = application_.JoinGame(user_name, map_id_str);
 
+        app_tracing::Span serialize_span{"api.serialize"};
         boost::json::object out;
         out["authToken"] = result.auth_token;
         out["playerId"] = result.player_id;
@@ -184,23 +201,20 @@ StringResponse ApiHandler::HandleJoinRequest(http::verb method, std::string_view
     }
 }
 
-StringResponse ApiHandler::HandleMapsRequest(unsigned version, bool keep_alive) {
-    const auto& maps = application_.GetMaps();
-    boost::json::array array;
-    for (const auto& map : maps) {
-        boost::json::object map_obj;
-        std::string id = *map.GetId();
-        std::string name = map.GetName();
-        map_obj[std::string(keys::kId)] = id;
-        map_obj[std::string(keys::kName)] = name;
-        array.push_back(map_obj);
+ApiResponse ApiHandler::HandleMapsRequest(const Fields& headers, unsigned version,
+                                          bool keep_alive) {
+    app_tracing::Span span{"api.maps"};
+    const PreparedBody& prepared = map_responses_.GetMapList();
+    if (MatchesIfNoneMatch(headers, prepared.etag)) {
+        return MakeNotModified(prepared.etag, version, keep_alive);
     }
-    return MakeStringResponse(http::status::ok, boost::json::serialize(array), version, keep_alive,
-                              ContentType::JSON);
+    return MakeSharedResponse(http::status::ok, prepared.body, version, keep_alive,
+                              ContentType::JSON, prepared.etag);
 }
 
-StringResponse ApiHandler::HandleMapDataRequest(std::string_view target, unsigned version,
-                                                bool keep_alive) {
+ApiResponse ApiHandler::HandleMapDataRequest(std::string_view target, const Fields& headers,
+                                             unsigned version, bool keep_alive) {
+    app_tracing::Span span{"api.map"};
     auto id = url::ExtractMapId(target);
 
     if (!id) {
@@ -208,110 +222,58 @@ StringResponse ApiHandler::HandleMapDataRequest(std::string_view target, unsigne
                              keep_alive);
     }
 
-    auto map_id = model::Map::Id(std::string(*id));
-    const auto& map = application_.FindMap(map_id);
-    if (!map) {
+    const BodyEncoding encoding = SelectEncoding(headers);
+    const PreparedBody* prepared = map_responses_.FindMap(*id, encoding);
+    if (!prepared) {
         return MakeJsonError(http::status::not_found, "mapNotFound"sv, "Map not found"sv, version,
                              keep_alive);
     }
 
-    boost::json::object response_body;
-    response_body[std::string(keys::kId)] = *map->GetId();
-    response_body[std::string(keys::kName)] = map->GetName();
-
-    boost::json::array roads = json_serialization::GetRoadsFromMap(map);
-    response_body[std::string(keys::kRoads)] = std::move(roads);
-
-    boost::json::array buildings = json_serialization::GetBuildingsFromMap(map);
-    response_body[std::string(keys::kBuildings)] = std::move(buildings);
-
-    boost::json::array offices = json_serialization::GetOfficesFromMap(map);
-    response_body[std::string(keys::kOffices)] = std::move(offices);
-
-    return MakeStringResponse(http::status::ok, boost::json::serialize(response_body), version,
-                              keep_alive, ContentType::JSON);
+    if (MatchesIfNoneMatch(headers, prepared->etag)) {
+        auto response = MakeNotModified(prepared->etag, version, keep_alive);
+        response.set(http::field::vary, "Accept"sv);
+        return response;
+    }
+    auto response = MakeSharedResponse(
+        http::status::ok, prepared->body, version, keep_alive,
+        encoding == BodyEncoding::Binary ? ContentType::GAME_BINARY : ContentType::JSON,
+        prepared->etag);
+    response.set(http::field::vary, "Accept"sv);
+    return response;
 }
 
-StringResponse ApiHandler::HandlePlayersRequest(http::verb method, const http::fields& headers,
-                                                unsigned version, bool keep_alive) {
-    return ExecuteIfGetOrHead(method, version, keep_alive, [&] {
+ApiResponse ApiHandler::HandlePlayersRequest(http::verb method, const Fields& headers,
+                                             unsigned version, bool keep_alive) {
+    app_tracing::Span span{"api.players"};
+    return ExecuteIfGetOrHead(method, version, keep_alive, [&]() -> ApiResponse {
         return ExecuteAuthorized(headers, version, keep_alive, application_,
-                                 [&](std::string_view /*token*/, const auto& players_ids) {
-                                     json::object out;
-                                     for (int id : players_ids) {
-                                         if (auto* p = application_.GetPlayer(id)) {
-                                             out[std::to_string(id)] = {{"name", p->GetName()}};
-                                         }
-                                     }
-
-                                     if (method == http::verb::head) {
-                                         return MakeStringResponse(http::status::ok, ""sv, version,
-                                                                   keep_alive, ContentType::JSON);
-                                     }
-                                     return MakeStringResponse(http::status::ok,
-                                                               json::serialize(out), version,
-                                                               keep_alive, ContentType::JSON);
+                                 [&](const model::Player& me) -> ApiResponse {
+                                     const auto state = application_.GetSessionState(me);
+                                     return MakeSnapshotResponse(method, state->players_json,
+                                                                 state->players_binary, headers,
+                                                                 version, keep_alive);
                                  });
     });
 }
 
-StringResponse ApiHandler::HandleStateRequest(http::verb method, const http::fields& headers,
-                                              unsigned version, bool keep_alive) {
-    return ExecuteIfGetOrHead(method, version, keep_alive, [&] {
-        return ExecuteAuthorized(
-            headers, version, keep_alive, application_,
-            [&](std::string_view /*token*/, const auto& players_ids) {
-                json::object out;
-                json::object players_info;
-
-                for (int id : players_ids) {
-                    json::object player_info;
-
-                    if (auto* p = application_.GetPlayer(id)) {
-                        const auto& dog = p->GetDog();
-
-                        json::array pos{dog.GetPosition().x, dog.GetPosition().y};
-                        player_info["pos"] = std::move(pos);
-
-                        json::array speed{dog.GetVelocity().vx, dog.GetVelocity().vy};
-                        player_info["speed"] = std::move(speed);
-
-                        std::string dir = "U"s;
-                        switch (dog.GetDirection()) {
-                            case model::DogDirection::East:
-                                dir = "R"s;
-                                break;
-                            case model::DogDirection::West:
-                                dir = "L"s;
-                                break;
-                            case model::DogDirection::North:
-                                dir = "U"s;
-                                break;
-                            case model::DogDirection::South:
-                                dir = "D"s;
-                                break;
-                        }
-                        player_info["dir"] = dir;
-                    }
-
-                    players_info[std::to_string(id)] = std::move(player_info);
-                }
-
-                out["players"] = std::move(players_info);
-
-                if (method == http::verb::head) {
-                    return MakeStringResponse(http::status::ok, ""sv, version, keep_alive,
-                                              ContentType::JSON);
-                }
-                return MakeStringResponse(http::status::ok, json::serialize(out), version,
-                                          keep_alive, ContentType::JSON);
-            });
+ApiResponse ApiHandler::HandleStateRequest(http::verb method, const Fields& headers,
+                                           unsigned version, bool keep_alive) {
+    app_tracing::Span span{"api.state"};
+    return ExecuteIfGetOrHead(method, version, keep_alive, [&]() -> ApiResponse {
+        return ExecuteAuthorized(headers, version, keep_alive, application_,
+                                 [&](const model::Player& me) -> ApiResponse {
+                                     const auto state = application_.GetSessionState(me);
+                                     return MakeSnapshotResponse(method, state->state_json,
+                                                                 state->state_binary, headers,
+                                                                 version, keep_alive);
+                                 });
     });
 }
 
 StringResponse ApiHandler::HandleActionRequest(http::verb method, std::string_view body,
-                                               const http::fields& headers, unsigned version,
+                                               const Fields& headers, unsigned version,
                                                bool keep_alive) {
+    app_tracing::Span span{"api.action"};
     if (method != http::verb::post) {
         return MethodNotAllowed(version, keep_alive, "POST"sv);
     }
@@ -334,11 +296,16 @@ StringResponse ApiHandler::HandleActionRequest(http::verb method, std::string_vi
 
     return ExecuteAuthorized(
         headers, version, keep_alive, application_,
-        [&](std::string_view token, const auto& /*player_ids*/) {
-            boost::json::value parsed;
+        [&](model::Player& player) {
+            // Тело команды маленькое, и его разбор укладывается в буфер на стеке
+            unsigned char parse_buffer[512];
+            json::monotonic_resource parse_memory{parse_buffer, sizeof(parse_buffer)};
+            boost::json::value parsed{&parse_memory};
 
             try {
-                parsed = json::parse(boost::json::string_view(body.data(), body.size()));
+                app_tracing::Span parse_span{"api.parse"};
+                parsed = json::parse(boost::json::string_view(body.data(), body.size()),
+                                     &parse_memory);
             } catch (...) {
                 return MakeJsonError(http::status::bad_request, "invalidArgument"sv,
                                      "Failed to parse action"sv, version, keep_alive);
@@ -355,36 +322,17 @@ StringResponse ApiHandler::HandleActionRequest(http::verb method, std::string_vi
                                      "Failed to parse action"sv, version, keep_alive);
             }
 
-            auto player_id = application_.Authorize(token);
-            if (!player_id) {
-                return MakeJsonError(http::status::unauthorized, "invalidToken"sv,
-                                     "Invalid token"sv, version, keep_alive);
-            }
-
-            auto player = application_.GetPlayer(*player_id);
-            auto& dog = player->GetDog();
-            double speed;
-            if (player->LockSession()->GetMap().GetDogSpeed()) {
-                speed = *player->LockSession()->GetMap().GetDogSpeed();
-            } else {
-                speed = application_.GetGame().GetDefaultDogSpeed();
-            }
-
-            if (move.empty()) {
-                dog.SetVelocity({0.0, 0.0});
-            } else if (move == "R"sv) {
-                dog.SetVelocity({speed, 0.0});
-                dog.SetDirection(model::DogDirection::East);
+            std::optional<model::DogDirection> direction;
+            if (move == "R"sv) {
+                direction = model::DogDirection::East;
             } else if (move == "L"sv) {
-                dog.SetVelocity({-speed, 0.0});
-                dog.SetDirection(model::DogDirection::West);
+                direction = model::DogDirection::West;
             } else if (move == "U"sv) {
-                dog.SetVelocity({0.0, -speed});
-                dog.SetDirection(model::DogDirection::North);
-            } else {
-                dog.SetVelocity({0.0, speed});
-                dog.SetDirection(model::DogDirection::South);
+                direction = model::DogDirection::North;
+            } else if (move == "D"sv) {
+                direction = model::DogDirection::South;
             }
+            application_.SetPlayerMovement(player, direction);
 
             return MakeStringResponse(http::status::ok, "{}"sv, version, keep_alive,
                                       ContentType::JSON);
@@ -392,8 +340,9 @@ StringResponse ApiHandler::HandleActionRequest(http::verb method, std::string_vi
 }
 
 StringResponse ApiHandler::HandleTickRequest(http::verb method, std::string_view body,
-                                             const http::fields& headers, unsigned version,
+                                             const Fields& headers, unsigned version,
                                              bool keep_alive) {
+    app_tracing::Span span{"api.tick"};
     if (method != http::verb::post) {
         return MethodNotAllowed(version, keep_alive, "POST"sv);
     }
@@ -5,37 +5,45 @@
 
 #include "application.h"
 #include "http_types.h"
+#include "map_responses.h"
 
 namespace http_handler {
 class ApiHandler {
    public:
-    explicit ApiHandler(app::Application& application) : application_(application) {}
+    explicit ApiHandler(app::Application& application)
+        : application_(application), map_responses_(application.GetMaps()) {}
 
     template <typename Body, typename Allocator>
-    StringResponse Handle(http::request<Body, http::basic_fields<Allocator>>&& req) {
+    ApiResponse Handle(http::request<Body, http::basic_fields<Allocator>>&& req) {
         return HandleImpl(req.method(), req.target(), req.body(), req.base(), req.version(),
                           req.keep_alive());
     }
 
+    // Запросы, которые только читают опубликованные снимки и неизменяемые данные.
+    // Их можно обрабатывать в любом потоке, минуя strand приложения.
+    static bool IsConcurrentRead(http::verb method, std::string_view target) noexcept;
+
    private:
-    StringResponse HandleImpl(http::verb method, std::string_view target, std::string_view body,
-                              const http::fields& headers, unsigned version, bool keep_alive);
+    ApiResponse HandleImpl(http::verb method, std::string_view target, std::string_view body,
+                              const Fields& headers, unsigned version, bool keep_alive);
     StringResponse HandleJoinRequest(http::verb method, std::string_view body,
-                                     const http::fields& headers, unsigned version,
+                                     const Fields& headers, unsigned version,
                                      bool keep_alive);
-    StringResponse HandleMapsRequest(unsigned version, bool keep_alive);
-    StringResponse HandleMapDataRequest(std::string_view target, unsigned version, bool keep_alive);
-    StringResponse HandlePlayersRequest(http::verb method, const http::fields& headers,
-                                        unsigned version, bool keep_alive);
-    StringResponse HandleStateRequest(http::verb method, const http::fields& headers,
-                                      unsigned version, bool keep_alive);
+    ApiResponse HandleMapsRequest(const Fields& headers, unsigned version, bool keep_alive);
+    ApiResponse HandleMapDataRequest(std::string_view target, const Fields& headers,
+                                     unsigned version, bool keep_alive);
+    ApiResponse HandlePlayersRequest(http::verb method, const Fields& headers,
+                                     unsigned version, bool keep_alive);
+    ApiResponse HandleStateRequest(http::verb method, const Fields& headers,
+                                   unsigned version, bool keep_alive);
     StringResponse HandleActionRequest(http::verb method, std::string_view body,
-                                       const http::fields& headers, unsigned version,
+                                       const Fields& headers, unsigned version,
                                        bool keep_alive);
     StringResponse HandleTickRequest(http::verb method, std::string_view body,
-                                     const http::fields& headers, unsigned version, bool keep_alive);
+                                     const Fields& headers, unsigned version, bool keep_alive);
 
    private:
     app::Application& application_;
+    const MapResponses map_responses_;
 };
 }  // namespace http_handler
\ No newline at end of file
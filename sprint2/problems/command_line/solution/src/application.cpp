@@ -1,10 +1,49 @@
 #include "application.h"
 
+#include "binary_codec.h"
+#include "json_serializer.h"
+#include "metrics.h"
+#include "tracing.h"
+
 #include <chrono>
+#include <random>
 
 namespace app {
-Application::Application(model::Game game, bool randomize_dog_spawn, bool autotick)
-    : game_(std::move(game)), randomize_dog_spawn_(randomize_dog_spawn), autotick_(autotick) {}
+namespace {
+using namespace std::literals;
+
+model::EncodedBody Encode(std::string body, std::string etag) {
+    model::EncodedBody encoded;
+    encoded.etag = std::move(etag);
+    encoded.data = std::make_shared<const std::string>(std::move(body));
+    return encoded;
+}
+
+// ETag снимка вида "<эпоха>-<метка>-<формат>". Метка однозначно задаёт содержимое внутри
+// сессии, поэтому тело не нужно хешировать. Случайная эпоха не даёт ETag, сохранённому
+// клиентом до перезапуска сервера, совпасть с другим состоянием.
+std::string FrameETag(std::uint32_t epoch, std::string_view label, std::string_view format) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string etag = "\""s;
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        etag += kHex[(epoch >> shift) & 0xF];
+    }
+    etag += '-';
+    etag += label;
+    etag += '-';
+    etag += format;
+    etag += '"';
+    return etag;
+}
+}  // namespace
+
+Application::Application(model::Game game, bool randomize_dog_spawn, bool autotick,
+                         unsigned tick_threads)
+    : game_(std::move(game)),
+      randomize_dog_spawn_(randomize_dog_spawn),
+      autotick_(autotick),
+      tick_engine_(tick_threads),
+      etag_epoch_(std::random_device{}()) {}
 
 Application::JoinResult Application::JoinGame(std::string user_name, std::string map_id_str) {
     model::Map::Id map_id{map_id_str};
@@ -15,14 +54,26 @@ Application::JoinResult Application::JoinGame(std::string user_name, std::string
 
     auto session = game_.GetOrCreateSession(map_id);
     int player_id = players_.AddPlayer(session, std::move(user_name), randomize_dog_spawn_);
+    model::Player* player = players_.Find(player_id);
+
+    session->AddToRoster(player_id, player->GetName());
+    // При автоматическом тике новый игрок появится в снимке на ближайшем тике.
+    // Первый снимок сессии публикуется сразу, чтобы читателям было что отдать.
+    if (!autotick_ || session->GetState()->revision == 0) {
+        PublishSession(*session);
+    }
+
+    app_metrics::SetGauge(app_metrics::Gauge::Players, static_cast<std::int64_t>(players_.Count()));
+    app_metrics::SetGauge(app_metrics::Gauge::Sessions,
+                          static_cast<std::int64_t>(game_.GetSessions().size()));
 
-    std::string token = *tokens_.Issue(player_id);
+    std::string token = *tokens_.Issue(player);
 
     return JoinResult{std::move(token), player_id};
 }
 
-std::optional<int> Application::Authorize(std::string_view token) const {
-    return tokens_.FindPlayerId(token);
+model::Player* Application::Authorize(std::string_view token) const noexcept {
+    return tokens_.FindPlayer(token);
 }
 
 boost::json::object Application::GetPlayersJson(int player_id) const {
@@ -51,60 +102,128 @@ const std::vector<model::Map>& Application::GetMaps() const { return game_.GetMa
 
 const model::Map* Application::FindMap(const model::Map::Id& id) const { return game_.FindMap(id); }
 
-const model::Player* Application::GetPlayer(int player_id) const {
-    return players_.Find(player_id);
+std::shared_ptr<const model::SessionState> Application::GetSessionState(
+    const model::Player& player) const {
+    auto session = player.LockSession();
+    if (!session) {
+        return nullptr;
+    }
+    return session->GetState();
 }
 
-model::Player* Application::GetPlayer(int player_id) { return players_.Find(player_id); }
+void Application::SetPlayerMovement(model::Player& player,
+                                    std::optional<model::DogDirection> direction) {
+    auto session = player.LockSession();
+    if (!session) {
+        return;
+    }
 
-std::optional<std::vector<int>> Application::GetPlayers(std::string_view token) const {
-    auto maybe_player_id = tokens_.FindPlayerId(token);
-    if (!maybe_player_id) {
-        return std::nullopt;
+    const double speed = session->GetMap().GetDogSpeed().value_or(game_.GetDefaultDogSpeed());
+
+    auto& dog = player.GetDog();
+    if (!direction) {
+        dog.SetVelocity({0.0, 0.0});
+    } else {
+        switch (*direction) {
+            case model::DogDirection::East:
+                dog.SetVelocity({speed, 0.0});
+                break;
+            case model::DogDirection::West:
+                dog.SetVelocity({-speed, 0.0});
+                break;
+            case model::DogDirection::North:
+                dog.SetVelocity({0.0, -speed});
+                break;
+            case model::DogDirection::South:
+                dog.SetVelocity({0.0, speed});
+                break;
+        }
+        dog.SetDirection(*direction);
     }
 
-    const int player_id = *maybe_player_id;
-    auto* me = players_.Find(player_id);
-    if (!me) {
-        return std::nullopt;
+    // Снимок снимает ближайший тик: публикация на каждую команду стоила бы O(N) на команду
+    // и O(N^2) за тик. Без автоматического тика следующий тик может не наступить.
+    session->MarkChanged();
+    if (!autotick_) {
+        PublishSession(*session);
     }
+}
 
-    auto session = me->LockSession();
+void Application::Tick(std::chrono::milliseconds delta) {
+    const double dt = std::chrono::duration<double>(delta).count();
+    const auto& sessions = game_.GetSessions();
+    app_tracing::Span span{"game.tick", static_cast<std::int64_t>(sessions.size())};
+
+    // Сессии не разделяют собак, поэтому их можно обновлять независимо
+    tick_engine_.Run(sessions.size(), [&](std::size_t i) { TickSession(sessions[i], dt); });
+}
+
+void Application::TickSession(const std::shared_ptr<model::GameSession>& session, double dt) {
+    {
+        app_tracing::Span span{"game.move"};
+        session->Tick(dt);
+    }
+    PublishSession(*session);
+}
+
+std::shared_ptr<const model::SessionState> Application::SubscribeToState(
+    const model::Player& player, std::weak_ptr<StateSubscriber> subscriber) {
+    auto session = player.LockSession();
     if (!session) {
-        return std::nullopt;
+        return nullptr;
     }
+    // Подписка оформляется раньше чтения снимка, поэтому ни одна ревизия не теряется
+    state_hub_.Subscribe(*session, std::move(subscriber));
+    return session->GetState();
+}
 
-    const auto* ids = players_.ListInSession(session);
-    if (!ids) {
-        return std::nullopt;
+void Application::PublishSession(model::GameSession& session) {
+    app_tracing::Span span{"game.publish"};
+    auto state = session.CaptureState();
+    if (!state) {
+        return;
     }
 
-    return std::vector<int>(ids->begin(), ids->end());
-}
+    // Снимок помечается тиком и ревизией: ревизия различает снимки одного тика,
+    // снятые после команд игроков в режиме ручного тика
+    const std::string frame_label =
+        std::to_string(state->tick) + "." + std::to_string(state->revision);
+    {
+        app_tracing::Span encode_span{"game.encode_json"};
+        state->state_json = Encode(json_serialization::SerializeSessionState(*state),
+                                   FrameETag(etag_epoch_, frame_label, "json"sv));
+    }
+    {
+        app_tracing::Span encode_span{"game.encode_binary"};
+        state->state_binary = Encode(binary_protocol::EncodeState(*state),
+                                     FrameETag(etag_epoch_, frame_label, "bin"sv));
+    }
 
-void Application::Tick(std::chrono::milliseconds delta) {
-    const double dt = std::chrono::duration<double>(delta).count();
-    auto maps = GetMaps();
-    for (const auto& map : maps) {
-        auto session = game_.GetSession(map.GetId());
-        if (session) {
-            auto* players = players_.ListInSession(session);
-            for (const int player_id : *players) {
-                auto& dog = players_.Find(player_id)->GetDog();
-
-                auto pos = dog.GetPosition();
-                auto vel = dog.GetVelocity();
-
-                model::DogPos target_pos{pos.x + dt * vel.vx, pos.y + dt * vel.vy};
-                auto projected_move = map.ProjectMove(pos, vel, dt);
-
-                if (projected_move.stopped_by_boundary) {
-                    dog.SetVelocity({0.0, 0.0});
-                }
-                dog.SetPosition(projected_move.new_pos);
-            }
-        }
+    // Список игроков меняется редко, поэтому его тела переиспользуются между снимками
+    const auto previous = session.GetState();
+    if (previous->roster == state->roster && previous->players_json.data) {
+        state->players_json = previous->players_json;
+        state->players_binary = previous->players_binary;
+    } else {
+        app_tracing::Span encode_span{"game.encode_roster"};
+        const std::string roster_label = "p" + std::to_string(state->roster_revision);
+        state->players_json = Encode(json_serialization::SerializeRoster(state->roster),
+                                     FrameETag(etag_epoch_, roster_label, "json"sv));
+        state->players_binary = Encode(binary_protocol::EncodeRoster(state->roster),
+                                       FrameETag(etag_epoch_, roster_label, "bin"sv));
+    }
+
+    // Разностный кадр нужен только потоковым подписчикам. Подписавшийся в промежутке
+    // получит снимок без кадра и запросит полное состояние.
+    if (state_hub_.HasSubscribers(session)) {
+        app_tracing::Span encode_span{"game.encode_delta"};
+        state->delta_body = std::make_shared<const std::string>(
+            json_serialization::SerializeStateFrame(*state, previous.get()));
     }
+
+    std::shared_ptr<const model::SessionState> published = std::move(state);
+    session.PublishState(published);
+    state_hub_.Publish(session, published);
 }
 
 }  // namespace app
\ No newline at end of file
@@ -2,16 +2,19 @@
 
 #include <boost/json.hpp>
 #include <chrono>
+#include <cstdint>
 
 #include "model.h"
 #include "player.h"
 #include "player_tokens.h"
 #include "players.h"
+#include "state_hub.h"
+#include "tick_engine.h"
 
 namespace app {
 class Application {
    public:
-    explicit Application(model::Game game, bool randomize_dog_spawn, bool autotick);
+    Application(model::Game game, bool randomize_dog_spawn, bool autotick, unsigned tick_threads);
 
     struct JoinResult {
         std::string auth_token;
@@ -20,15 +23,23 @@ class Application {
 
     JoinResult JoinGame(std::string user_name, std::string map_id);
 
-    std::optional<int> Authorize(std::string_view token) const;
+    // Игрок, которому выдан token, или nullptr
+    model::Player* Authorize(std::string_view token) const noexcept;
 
     boost::json::object GetPlayersJson(int player_id) const;
 
     const std::vector<model::Map>& GetMaps() const;
     const model::Map* FindMap(const model::Map::Id& id) const;
-    std::optional<std::vector<int>> GetPlayers(std::string_view token) const;
-    const model::Player* GetPlayer(int player_id) const;
-    model::Player* GetPlayer(int player_id);
+
+    // Снимок сессии игрока; безопасен для вызова из любого потока
+    std::shared_ptr<const model::SessionState> GetSessionState(const model::Player& player) const;
+
+    // Подписывает на снимки сессии игрока и возвращает текущий снимок (nullptr, если сессии нет)
+    std::shared_ptr<const model::SessionState> SubscribeToState(
+        const model::Player& player, std::weak_ptr<StateSubscriber> subscriber);
+
+    // Задаёт направление движения собаки игрока, nullopt - остановка
+    void SetPlayerMovement(model::Player& player, std::optional<model::DogDirection> direction);
 
     model::Game& GetGame() noexcept { return game_; }
     const model::Game& GetGame() const noexcept { return game_; }
@@ -38,10 +49,18 @@ class Application {
     void Tick(std::chrono::milliseconds delta);
 
    private:
+    void TickSession(const std::shared_ptr<model::GameSession>& session, double dt);
+    // Снимает состояние сессии, сериализует его один раз и публикует для читателей
+    void PublishSession(model::GameSession& session);
+
     model::Game game_;
     Players players_;
     PlayerTokens tokens_;
     bool randomize_dog_spawn_;
     bool autotick_;
+    TickEngine tick_engine_;
+    StateHub state_hub_;
+    // случайная часть ETag снимков, своя у каждого запуска сервера
+    std::uint32_t etag_epoch_;
 };
 }  // namespace app
\ No newline at end of file
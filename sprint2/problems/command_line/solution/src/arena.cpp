@@ -0,0 +1,50 @@
+#include "arena.h"
+
+#include <bit>
+
+namespace http_server {
+
+ConnectionArena::~ConnectionArena() {
+    for (std::size_t i = 0; i < kClassCount; ++i) {
+        for (FreeBlock* block = free_[i]; block;) {
+            FreeBlock* next = block->next;
+            ::operator delete(block, kMinBlockSize << i);
+            block = next;
+        }
+    }
+}
+
+std::size_t ConnectionArena::SizeClass(std::size_t bytes) noexcept {
+    if (bytes <= kMinBlockSize) {
+        return 0;
+    }
+    return std::bit_width((bytes - 1) / kMinBlockSize);
+}
+
+void* ConnectionArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (bytes > kMaxBlockSize || alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    const std::size_t size_class = SizeClass(bytes);
+    {
+        std::lock_guard lock{mutex_};
+        if (FreeBlock* block = free_[size_class]) {
+            free_[size_class] = block->next;
+            return block;
+        }
+    }
+    return ::operator new(kMinBlockSize << size_class);
+}
+
+void ConnectionArena::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    if (bytes > kMaxBlockSize || alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return ::operator delete(p, bytes, std::align_val_t{alignment});
+    }
+
+    const std::size_t size_class = SizeClass(bytes);
+    std::lock_guard lock{mutex_};
+    free_[size_class] = new (p) FreeBlock{free_[size_class]};
+}
+
+}  // namespace http_server
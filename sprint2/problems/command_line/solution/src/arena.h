@@ -0,0 +1,122 @@
+#pragma once
+#include <array>
+#include <boost/beast/http.hpp>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace http_server {
+namespace http = boost::beast::http;
+
+// Аллокатор поверх std::pmr::memory_resource. В отличие от std::pmr::polymorphic_allocator
+// допускает присваивание, которого требует http::basic_fields, и переходит вместе с
+// контейнером при перемещении.
+template <typename T>
+class PoolAllocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PoolAllocator() noexcept : resource_{std::pmr::get_default_resource()} {}
+    PoolAllocator(std::pmr::memory_resource* resource) noexcept : resource_{resource} {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : resource_{other.GetResource()} {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        resource_->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    std::pmr::memory_resource* GetResource() const noexcept { return resource_; }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept {
+        return resource_ == other.GetResource();
+    }
+
+   private:
+    std::pmr::memory_resource* resource_;
+};
+
+using Allocator = PoolAllocator<char>;
+using Fields = http::basic_fields<Allocator>;
+using StringBody = http::basic_string_body<char, std::char_traits<char>, Allocator>;
+using Request = http::request<StringBody, Fields>;
+
+// Память соединения. Освобождённые блоки раскладываются по спискам размеров и достаются
+// следующим запросам, поэтому keep-alive соединение после прогрева не обращается к malloc.
+// Запрос может уничтожаться в strand приложения, пока соединение читает следующий,
+// поэтому списки защищены мьютексом.
+class ConnectionArena final : public std::pmr::memory_resource {
+   public:
+    ConnectionArena() = default;
+    ConnectionArena(const ConnectionArena&) = delete;
+    ConnectionArena& operator=(const ConnectionArena&) = delete;
+    ~ConnectionArena() override;
+
+   private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr std::size_t kMinBlockSize = 32;
+    static constexpr std::size_t kClassCount = 8;  // 32 .. 4096 байт
+    static constexpr std::size_t kMaxBlockSize = kMinBlockSize << (kClassCount - 1);
+
+    static std::size_t SizeClass(std::size_t bytes) noexcept;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::mutex mutex_;
+    std::array<FreeBlock*, kClassCount> free_{};
+};
+
+// Место под ответ, который пишется в соединение. Одновременно пишется не больше одного
+// ответа, поэтому буфер растёт до размера самого большого типа ответа и затем переиспользуется.
+class ResponseSlot {
+   public:
+    ResponseSlot() = default;
+    ResponseSlot(const ResponseSlot&) = delete;
+    ResponseSlot& operator=(const ResponseSlot&) = delete;
+    ~ResponseSlot() { Reset(); }
+
+    template <typename T, typename... Args>
+    T& Emplace(Args&&... args) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        Reset();
+        if (capacity_ < sizeof(T)) {
+            storage_ = std::make_unique<std::byte[]>(sizeof(T));
+            capacity_ = sizeof(T);
+        }
+        T* object = new (storage_.get()) T(std::forward<Args>(args)...);
+        destroy_ = [](void* p) noexcept { static_cast<T*>(p)->~T(); };
+        object_ = object;
+        return *object;
+    }
+
+    void Reset() noexcept {
+        if (object_) {
+            destroy_(object_);
+            object_ = nullptr;
+        }
+    }
+
+   private:
+    std::unique_ptr<std::byte[]> storage_;
+    std::size_t capacity_ = 0;
+    void* object_ = nullptr;
+    void (*destroy_)(void*) noexcept = nullptr;
+};
+
+}  // namespace http_server
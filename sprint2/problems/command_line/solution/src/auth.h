@@ -0,0 +1,38 @@
+#pragma once
+#include <boost/beast/http.hpp>
+#include <optional>
+#include <string_view>
+
+#include "http_types.h"
+#include "player_tokens.h"
+
+namespace http_handler {
+namespace http = boost::beast::http;
+using namespace std::literals;
+
+inline bool IsHex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+inline bool IsValidTokenFormat(std::string_view token) {
+    if (token.size() != app::PlayerTokens::TOKEN_LENGTH) return false;
+    for (char c : token) {
+        if (!IsHex(c)) return false;
+    }
+    return true;
+}
+
+inline std::optional<std::string_view> ExtractBearerToken(const Fields& headers) {
+    auto it = headers.find(http::field::authorization);
+    if (it == headers.end()) return std::nullopt;
+
+    std::string_view v = it->value();
+    constexpr std::string_view kPrefix = "Bearer "sv;
+    if (!v.starts_with(kPrefix)) return std::nullopt;
+
+    v.remove_prefix(kPrefix.size());
+    if (v.empty()) return std::nullopt;
+
+    return v;
+}
+}  // namespace http_handler
@@ -0,0 +1,305 @@
+#include "binary_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace binary_protocol {
+using namespace std::literals;
+
+namespace {
+
+class Writer {
+   public:
+    Writer(MessageType type, std::size_t size_hint) {
+        out_.reserve(size_hint);
+        U8(static_cast<std::uint8_t>(type));
+        U8(kVersion);
+    }
+
+    void U8(std::uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void Varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            U8(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        U8(static_cast<std::uint8_t>(value));
+    }
+
+    void ZigZag(std::int64_t value) {
+        Varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void I32(std::int32_t value) {
+        const auto bits = static_cast<std::uint32_t>(value);
+        for (int shift = 0; shift < 32; shift += 8) {
+            U8(static_cast<std::uint8_t>(bits >> shift));
+        }
+    }
+
+    void Fixed(double value) {
+        constexpr double kMin = std::numeric_limits<std::int32_t>::min();
+        constexpr double kMax = std::numeric_limits<std::int32_t>::max();
+        const double scaled = std::round(value * kFixedPointScale);
+        I32(static_cast<std::int32_t>(std::clamp(scaled, kMin, kMax)));
+    }
+
+    void String(std::string_view value) {
+        Varint(value.size());
+        out_.append(value);
+    }
+
+    std::string Release() { return std::move(out_); }
+
+   private:
+    std::string out_;
+};
+
+class Reader {
+   public:
+    Reader(std::string_view data, MessageType expected) : data_(data) {
+        if (U8() != static_cast<std::uint8_t>(expected)) {
+            throw std::invalid_argument("Unexpected binary message type"s);
+        }
+        if (U8() != kVersion) {
+            throw std::invalid_argument("Unsupported binary message version"s);
+        }
+    }
+
+    std::uint8_t U8() {
+        Require(1);
+        const auto value = static_cast<std::uint8_t>(data_.front());
+        data_.remove_prefix(1);
+        return value;
+    }
+
+    std::uint64_t Varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t byte = U8();
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::invalid_argument("Malformed varint"s);
+    }
+
+    std::int64_t ZigZag() {
+        const std::uint64_t value = Varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::int32_t I32() {
+        std::uint32_t bits = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            bits |= static_cast<std::uint32_t>(U8()) << shift;
+        }
+        return static_cast<std::int32_t>(bits);
+    }
+
+    double Fixed() { return I32() / kFixedPointScale; }
+
+    std::string String() {
+        const std::uint64_t size = Varint();
+        Require(size);
+        std::string value{data_.substr(0, size)};
+        data_.remove_prefix(size);
+        return value;
+    }
+
+    // Число элементов, каждый из которых занимает не меньше min_size байт
+    std::size_t Count(std::size_t min_size) {
+        const std::uint64_t count = Varint();
+        if (count > data_.size() / min_size) {
+            throw std::invalid_argument("Truncated binary message"s);
+        }
+        return count;
+    }
+
+    void ExpectEnd() const {
+        if (!data_.empty()) {
+            throw std::invalid_argument("Trailing bytes in binary message"s);
+        }
+    }
+
+   private:
+    void Require(std::uint64_t size) const {
+        if (data_.size() < size) {
+            throw std::invalid_argument("Truncated binary message"s);
+        }
+    }
+
+    std::string_view data_;
+};
+
+// Минимальные размеры записей: varint занимает хотя бы один байт
+constexpr std::size_t kDogRecordMinSize = 1 + 4 * 4 + 1;
+constexpr std::size_t kPlayerRecordMinSize = 2;
+constexpr std::size_t kRoadRecordMinSize = 4;
+constexpr std::size_t kBuildingRecordMinSize = 4;
+constexpr std::size_t kOfficeRecordMinSize = 5;
+
+constexpr std::size_t kMaxVarintSize = 10;
+
+int ToPlayerId(std::uint64_t value) {
+    if (value > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        throw std::invalid_argument("Player id is out of range"s);
+    }
+    return static_cast<int>(value);
+}
+
+model::Coord ToCoord(std::int64_t value) {
+    if (value < std::numeric_limits<model::Coord>::min() ||
+        value > std::numeric_limits<model::Coord>::max()) {
+        throw std::invalid_argument("Coordinate is out of range"s);
+    }
+    return static_cast<model::Coord>(value);
+}
+
+}  // namespace
+
+std::string EncodeState(const model::SessionState& state) {
+    Writer writer{MessageType::State,
+                  2 + 2 * kMaxVarintSize + state.dogs.size() * (kDogRecordMinSize + 4)};
+    writer.Varint(state.tick);
+    writer.Varint(state.dogs.size());
+    for (std::size_t i = 0; i < state.dogs.size(); ++i) {
+        const model::DogState& dog = state.dogs[i];
+        writer.Varint(static_cast<std::uint64_t>(state.roster[i].player_id));
+        writer.Fixed(dog.position.x);
+        writer.Fixed(dog.position.y);
+        writer.Fixed(dog.velocity.vx);
+        writer.Fixed(dog.velocity.vy);
+        writer.U8(static_cast<std::uint8_t>(dog.direction));
+    }
+    return writer.Release();
+}
+
+std::string EncodeRoster(const model::SessionRoster& roster) {
+    Writer writer{MessageType::Players, 2 + kMaxVarintSize + roster.Size() * 16};
+    writer.Varint(roster.Size());
+    for (std::size_t i = 0; i < roster.Size(); ++i) {
+        writer.Varint(static_cast<std::uint64_t>(roster[i].player_id));
+        writer.String(roster[i].name);
+    }
+    return writer.Release();
+}
+
+std::string EncodeMap(const model::Map& map) {
+    Writer writer{MessageType::Map, 64 + map.GetRoads().size() * 8};
+    writer.String(*map.GetId());
+    writer.String(map.GetName());
+
+    // road: u8 horizontal, x0, y0, x1 или y1
+    writer.Varint(map.GetRoads().size());
+    for (const auto& road : map.GetRoads()) {
+        const bool horizontal = road.IsHorizontal();
+        writer.U8(horizontal ? 1 : 0);
+        writer.ZigZag(road.GetStart().x);
+        writer.ZigZag(road.GetStart().y);
+        writer.ZigZag(horizontal ? road.GetEnd().x : road.GetEnd().y);
+    }
+
+    // building: x, y, w, h
+    writer.Varint(map.GetBuildings().size());
+    for (const auto& building : map.GetBuildings()) {
+        const model::Rectangle& bounds = building.GetBounds();
+        writer.ZigZag(bounds.position.x);
+        writer.ZigZag(bounds.position.y);
+        writer.ZigZag(bounds.size.width);
+        writer.ZigZag(bounds.size.height);
+    }
+
+    // office: string id, x, y, offsetX, offsetY
+    writer.Varint(map.GetOffices().size());
+    for (const auto& office : map.GetOffices()) {
+        writer.String(*office.GetId());
+        writer.ZigZag(office.GetPosition().x);
+        writer.ZigZag(office.GetPosition().y);
+        writer.ZigZag(office.GetOffset().dx);
+        writer.ZigZag(office.GetOffset().dy);
+    }
+    return writer.Release();
+}
+
+DecodedState DecodeState(std::string_view data) {
+    Reader reader{data, MessageType::State};
+
+    DecodedState state;
+    state.tick = reader.Varint();
+    const std::size_t count = reader.Count(kDogRecordMinSize);
+    state.dogs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        DecodedDog dog;
+        dog.player_id = ToPlayerId(reader.Varint());
+        dog.state.position.x = reader.Fixed();
+        dog.state.position.y = reader.Fixed();
+        dog.state.velocity.vx = reader.Fixed();
+        dog.state.velocity.vy = reader.Fixed();
+        const std::uint8_t dir = reader.U8();
+        if (dir > static_cast<std::uint8_t>(model::DogDirection::West)) {
+            throw std::invalid_argument("Invalid dog direction"s);
+        }
+        dog.state.direction = static_cast<model::DogDirection>(dir);
+        state.dogs.push_back(dog);
+    }
+    reader.ExpectEnd();
+    return state;
+}
+
+model::SessionRoster DecodeRoster(std::string_view data) {
+    Reader reader{data, MessageType::Players};
+
+    model::SessionRoster roster;
+    const std::size_t count = reader.Count(kPlayerRecordMinSize);
+    for (std::size_t i = 0; i < count; ++i) {
+        const int player_id = ToPlayerId(reader.Varint());
+        roster.Append(player_id, reader.String());
+    }
+    reader.ExpectEnd();
+    return roster;
+}
+
+model::Map DecodeMap(std::string_view data) {
+    Reader reader{data, MessageType::Map};
+
+    model::Map::Id id{reader.String()};
+    model::Map map{std::move(id), reader.String()};
+
+    const std::size_t roads = reader.Count(kRoadRecordMinSize);
+    for (std::size_t i = 0; i < roads; ++i) {
+        const bool horizontal = reader.U8() != 0;
+        const model::Point start{ToCoord(reader.ZigZag()), ToCoord(reader.ZigZag())};
+        const model::Coord end = ToCoord(reader.ZigZag());
+        if (horizontal) {
+            map.AddRoad({model::Road::HORIZONTAL, start, end});
+        } else {
+            map.AddRoad({model::Road::VERTICAL, start, end});
+        }
+    }
+
+    const std::size_t buildings = reader.Count(kBuildingRecordMinSize);
+    for (std::size_t i = 0; i < buildings; ++i) {
+        model::Rectangle bounds;
+        bounds.position = {ToCoord(reader.ZigZag()), ToCoord(reader.ZigZag())};
+        bounds.size = {ToCoord(reader.ZigZag()), ToCoord(reader.ZigZag())};
+        map.AddBuilding(model::Building{bounds});
+    }
+
+    const std::size_t offices = reader.Count(kOfficeRecordMinSize);
+    for (std::size_t i = 0; i < offices; ++i) {
+        model::Office::Id office_id{reader.String()};
+        const model::Point position{ToCoord(reader.ZigZag()), ToCoord(reader.ZigZag())};
+        const model::Offset offset{ToCoord(reader.ZigZag()), ToCoord(reader.ZigZag())};
+        map.AddOffice({std::move(office_id), position, offset});
+    }
+    reader.ExpectEnd();
+
+    map.BuildRoadIndex();
+    return map;
+}
+
+}  // namespace binary_protocol
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model.h"
+#include "session.h"
+
+// Компактное двоичное представление ответов /game/state, /game/players и /maps/{id}.
+//
+// Сообщение начинается с байта MessageType и байта версии формата. Далее:
+//  - целые без знака (идентификаторы, длины, счётчики) - varint (LEB128);
+//  - целочисленные координаты карт - zigzag varint;
+//  - координаты и скорости собак - int32 little-endian с фиксированной точкой,
+//    1/kFixedPointScale клетки;
+//  - строки - varint длины и байты UTF-8.
+namespace binary_protocol {
+
+inline constexpr std::uint8_t kVersion = 1;
+// Степень двойки: дробные части вида k/1024 передаются без потерь
+inline constexpr double kFixedPointScale = 1024.0;
+
+enum class MessageType : std::uint8_t { State = 1, Players = 2, Map = 3 };
+
+// state:   varint tick, varint count, count * {varint id, int32 x, y, vx, vy, u8 dir}
+std::string EncodeState(const model::SessionState& state);
+// players: varint count, count * {varint id, string name}
+std::string EncodeRoster(const model::SessionRoster& roster);
+// map:     string id, string name, roads, buildings, offices (см. binary_codec.cpp)
+std::string EncodeMap(const model::Map& map);
+
+struct DecodedDog {
+    int player_id;
+    model::DogState state;
+};
+
+struct DecodedState {
+    std::uint64_t tick = 0;
+    std::vector<DecodedDog> dogs;
+};
+
+// Декодеры бросают std::invalid_argument, если сообщение повреждено или другого типа
+DecodedState DecodeState(std::string_view data);
+model::SessionRoster DecodeRoster(std::string_view data);
+model::Map DecodeMap(std::string_view data);
+
+}  // namespace binary_protocol
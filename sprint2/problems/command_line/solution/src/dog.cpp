@@ -4,21 +4,21 @@
 
 namespace model {
 
-Dog::Dog(std::string name)
-    : name_(name), direction_(DogDirection::North), velocity_(), position_() {}
+Dog::Dog(std::string name, DogStore& store, DogStore::Index index)
+    : name_(std::move(name)), store_(&store), index_(index) {}
 
-void Dog::SetPosition(DogPos position) { position_ = position; }
+void Dog::SetPosition(DogPos position) { store_->SetPosition(index_, position); }
 
-void Dog::SetDirection(DogDirection direction) { direction_ = direction; }
+void Dog::SetDirection(DogDirection direction) { store_->SetDirection(index_, direction); }
 
-void Dog::SetVelocity(DogVelocity velocity) { velocity_ = velocity; }
+void Dog::SetVelocity(DogVelocity velocity) { store_->SetVelocity(index_, velocity); }
 
 const std::string& Dog::GetName() const noexcept { return name_; }
 
-const DogDirection Dog::GetDirection() const noexcept { return direction_; }
+const DogDirection Dog::GetDirection() const noexcept { return store_->GetDirection(index_); }
 
-const DogPos Dog::GetPosition() const noexcept { return position_; }
+const DogPos Dog::GetPosition() const noexcept { return store_->GetPosition(index_); }
 
-const DogVelocity Dog::GetVelocity() const noexcept { return velocity_; }
+const DogVelocity Dog::GetVelocity() const noexcept { return store_->GetVelocity(index_); }
 
-}  // namespace model
\ No newline at end of file
+}  // namespace model
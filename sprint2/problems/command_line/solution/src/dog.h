@@ -2,12 +2,15 @@
 
 #include <string>
 
+#include "dog_store.h"
 #include "model.h"
 
 namespace model {
+// Собака игрока. Координаты, скорость и направление хранятся в DogStore
+// игровой сессии, сам объект хранит только имя и индекс в хранилище.
 class Dog {
    public:
-    explicit Dog(std::string name);
+    Dog(std::string name, DogStore& store, DogStore::Index index);
 
     void SetPosition(DogPos position);
     void SetDirection(DogDirection direction);
@@ -20,8 +23,7 @@ class Dog {
 
    private:
     std::string name_;
-    DogDirection direction_ = DogDirection::North;
-    DogVelocity velocity_ = {0.0, 0.0};
-    DogPos position_;
+    DogStore* store_;
+    DogStore::Index index_;
 };
-}  // namespace model
\ No newline at end of file
+}  // namespace model
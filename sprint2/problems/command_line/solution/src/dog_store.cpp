@@ -0,0 +1,63 @@
+#include "dog_store.h"
+
+namespace model {
+
+DogStore::Index DogStore::Add(DogPos position, DogVelocity velocity, DogDirection direction) {
+    const Index index = x_.size();
+    x_.push_back(position.x);
+    y_.push_back(position.y);
+    vx_.push_back(velocity.vx);
+    vy_.push_back(velocity.vy);
+    road_.push_back(map_->FindRoadIdAt(position).value_or(Map::NO_ROAD));
+    direction_.push_back(direction);
+    return index;
+}
+
+void DogStore::SetPosition(Index i, DogPos position) {
+    x_[i] = position.x;
+    y_[i] = position.y;
+    road_[i] = map_->FindRoadIdAt(position).value_or(Map::NO_ROAD);
+}
+
+bool DogStore::Integrate(double dt) {
+    const std::size_t n = Size();
+    target_x_.resize(n);
+    target_y_.resize(n);
+
+    double* __restrict tx = target_x_.data();
+    double* __restrict ty = target_y_.data();
+    double* __restrict x = x_.data();
+    double* __restrict y = y_.data();
+    double* __restrict vx = vx_.data();
+    double* __restrict vy = vy_.data();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        tx[i] = x[i] + vx[i] * dt;
+        ty[i] = y[i] + vy[i] * dt;
+    }
+
+    bool moved = false;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (vx[i] == 0.0 && vy[i] == 0.0) {
+            continue;
+        }
+        moved = true;
+
+        // Быстрый путь: собака не покидает свою дорогу
+        const RoadIndex::RoadId road = road_[i];
+        if (road != Map::NO_ROAD && map_->GetRoadBounds(road).Contains(tx[i], ty[i])) {
+            x[i] = tx[i];
+            y[i] = ty[i];
+            continue;
+        }
+
+        const MoveResult move = map_->ProjectMove({x[i], y[i]}, {vx[i], vy[i]}, dt);
+        if (move.stopped_by_boundary) {
+            vx[i] = vy[i] = 0.0;
+        }
+        SetPosition(i, move.new_pos);
+    }
+    return moved;
+}
+
+}  // namespace model
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "model.h"
+
+namespace model {
+
+// Состояние всех собак игровой сессии в виде структуры массивов.
+// Координаты и скорости лежат в отдельных непрерывных массивах,
+// поэтому интегрирование движения за тик векторизуется компилятором.
+class DogStore {
+   public:
+    using Index = std::size_t;
+
+    explicit DogStore(const Map& map) : map_{&map} {}
+
+    Index Add(DogPos position, DogVelocity velocity = {},
+              DogDirection direction = DogDirection::North);
+
+    std::size_t Size() const noexcept { return x_.size(); }
+
+    DogPos GetPosition(Index i) const noexcept { return {x_[i], y_[i]}; }
+    DogVelocity GetVelocity(Index i) const noexcept { return {vx_[i], vy_[i]}; }
+    DogDirection GetDirection(Index i) const noexcept { return direction_[i]; }
+
+    void SetPosition(Index i, DogPos position);
+    void SetVelocity(Index i, DogVelocity velocity) noexcept {
+        vx_[i] = velocity.vx;
+        vy_[i] = velocity.vy;
+    }
+    void SetDirection(Index i, DogDirection direction) noexcept { direction_[i] = direction; }
+
+    // Перемещает всех собак на dt секунд с учётом границ дорог.
+    // Возвращает false, если ни одна собака не двигалась.
+    bool Integrate(double dt);
+
+   private:
+    const Map* map_;
+
+    std::vector<double> x_, y_;
+    std::vector<double> vx_, vy_;
+    // дорога, на которой стоит собака, или Map::NO_ROAD
+    std::vector<RoadIndex::RoadId> road_;
+    std::vector<DogDirection> direction_;
+
+    // целевые координаты тика, хранятся между вызовами, чтобы не выделять память
+    std::vector<double> target_x_, target_y_;
+};
+
+}  // namespace model
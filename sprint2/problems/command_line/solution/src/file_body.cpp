@@ -0,0 +1,61 @@
+#include "file_body.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/asio/error.hpp>
+#include <cerrno>
+#include <system_error>
+
+namespace http_server {
+
+std::shared_ptr<const FileDescriptor> FileDescriptor::Open(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Can't open " + path.string());
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Can't stat " + path.string());
+    }
+    return std::shared_ptr<const FileDescriptor>(
+        new FileDescriptor(fd, static_cast<std::uint64_t>(st.st_size)));
+}
+
+FileDescriptor::~FileDescriptor() { ::close(fd_); }
+
+boost::optional<std::pair<FileRangeBody::writer::const_buffers_type, bool>>
+FileRangeBody::writer::get(beast::error_code& ec) {
+    ec = {};
+    if (read_ == body_.size) {
+        return boost::none;
+    }
+
+    const auto chunk = std::min<std::uint64_t>(buffer_.size(), body_.size - read_);
+    ssize_t bytes_read;
+    do {
+        bytes_read = ::pread(body_.file->Get(), buffer_.data(), chunk,
+                             static_cast<off_t>(body_.offset + read_));
+    } while (bytes_read < 0 && errno == EINTR);
+
+    if (bytes_read < 0) {
+        ec.assign(errno, boost::system::system_category());
+        return boost::none;
+    }
+    if (bytes_read == 0) {
+        // Файл укоротился после открытия
+        ec = boost::asio::error::eof;
+        return boost::none;
+    }
+
+    read_ += static_cast<std::uint64_t>(bytes_read);
+    return {{const_buffers_type{buffer_.data(), static_cast<std::size_t>(bytes_read)},
+             read_ < body_.size}};
+}
+
+}  // namespace http_server
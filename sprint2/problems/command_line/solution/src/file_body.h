@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "arena.h"
+
+namespace http_server {
+namespace beast = boost::beast;
+
+// Открытый на чтение файл. Дескриптор закрывается вместе с последней ссылкой на объект,
+// поэтому ответ, начатый до перезагрузки StaticCache, дочитывает прежний файл.
+class FileDescriptor {
+   public:
+    static std::shared_ptr<const FileDescriptor> Open(const std::filesystem::path& path);
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    ~FileDescriptor();
+
+    int Get() const noexcept { return fd_; }
+    std::uint64_t Size() const noexcept { return size_; }
+
+   private:
+    FileDescriptor(int fd, std::uint64_t size) noexcept : fd_{fd}, size_{size} {}
+
+    int fd_;
+    std::uint64_t size_;
+};
+
+// Тело ответа - диапазон байт открытого файла. SessionBase отправляет его через sendfile,
+// минуя буферы процесса. writer читает файл через pread и нужен только при записи
+// ответа в другой поток (например, http::write).
+struct FileRangeBody {
+    struct value_type {
+        std::shared_ptr<const FileDescriptor> file;
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;
+    };
+
+    static std::uint64_t size(const value_type& body) noexcept { return body.size; }
+
+    class writer {
+       public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body) : body_(body) {}
+
+        void init(beast::error_code& ec) { ec = {}; }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec);
+
+       private:
+        const value_type& body_;
+        std::uint64_t read_ = 0;
+        std::array<char, 16 * 1024> buffer_;
+    };
+};
+
+using FileResponse = http::response<FileRangeBody, Fields>;
+
+}  // namespace http_server
@@ -1,25 +1,25 @@
 #pragma once
 #include <boost/beast/http.hpp>
-#include <boost/json.hpp>
 #include <filesystem>
 
 #include "http_response.h"
+#include "static_cache.h"
 #include "url_utils.h"
 
 namespace http_handler {
 namespace fs = std::filesystem;
 
+// Раздаёт файлы из StaticCache: обработка запроса не обращается к файловой системе
 class FileHandler {
    public:
-    explicit FileHandler(const fs::path& root) : root_(root) {}
+    explicit FileHandler(const StaticCache& cache) : cache_(cache) {}
 
     template <typename Body, typename Allocator, typename Send>
     void Handle(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
-        const std::string_view target = req.target();
         const auto version = req.version();
         const bool keep_alive = req.keep_alive();
 
-        std::string decoded_target = url::DecodeURI(target);
+        std::string decoded_target = url::DecodeURI(req.target());
 
         if (!decoded_target.empty() && decoded_target.front() == '/') {
             decoded_target.erase(decoded_target.begin());
@@ -29,41 +29,125 @@ class FileHandler {
             decoded_target = "index.html"s;
         }
 
-        fs::path requested = root_ / fs::path(decoded_target);
-
-        std::error_code ec;
-        fs::path requested_canonical = fs::weakly_canonical(requested, ec);
-
-        if (ec || !IsWithinRoot(requested_canonical)) {
+        const fs::path requested = fs::path(decoded_target).lexically_normal();
+        if (requested.is_absolute() || (!requested.empty() && *requested.begin() == "..")) {
             send(MakeStringResponse(http::status::bad_request, "Out of root", version, keep_alive,
                                     ContentType::TEXT));
             return;
         }
 
-        if (!fs::exists(requested_canonical)) {
+        const auto asset = cache_.Find(requested.generic_string());
+        if (!asset) {
             send(MakeStringResponse(http::status::not_found, "File not found", version, keep_alive,
                                     ContentType::TEXT));
             return;
         }
 
-        send(MakeFileResponse(http::status::ok, requested_canonical.string(), version, keep_alive,
-                              GetContentType(requested_canonical.string())));
+        const auto [variant, coding] = SelectVariant(*asset, req);
+        if (IsNotModified(req, *asset, *variant)) {
+            auto response = MakeNotModified(variant->etag, version, keep_alive);
+            SetAssetHeaders(response, *asset, coding);
+            send(std::move(response));
+            return;
+        }
+
+        const std::uint64_t total = variant->Size();
+        ByteRange range{0, total};
+        RangeResult range_result = RangeResult::Full;
+        if (auto it = req.find(http::field::range);
+            it != req.end() && IfRangeMatches(req, *asset, *variant)) {
+            range_result = ParseRange(it->value(), total, range);
+        }
+
+        if (range_result == RangeResult::Unsatisfiable) {
+            auto response = MakeStringResponse(http::status::range_not_satisfiable, ""sv, version,
+                                               keep_alive, asset->content_type);
+            response.set(http::field::content_range, "bytes */"s + std::to_string(total));
+            send(std::move(response));
+            return;
+        }
+
+        const auto status = range_result == RangeResult::Partial ? http::status::partial_content
+                                                                 : http::status::ok;
+        SendVariant(*asset, *variant, coding, status, range, req.method() == http::verb::head,
+                    version, keep_alive, send);
     }
 
    private:
-    bool IsWithinRoot(const fs::path& path) {
-        auto p_it = path.begin();
-        auto r_it = root_.begin();
-
-        for (; r_it != root_.end(); ++r_it, ++p_it) {
-            if (p_it == path.end() || *p_it != *r_it) {
-                return false;
+    template <typename Send>
+    static void SendVariant(const StaticAsset& asset, const AssetVariant& variant,
+                            ContentCoding coding, http::status status, ByteRange range, bool head,
+                            unsigned version, bool keep_alive, Send& send) {
+        const bool partial = status == http::status::partial_content;
+        auto finish = [&](auto&& response) {
+            SetAssetHeaders(response, asset, coding);
+            response.set(http::field::etag, variant.etag);
+            response.set(http::field::accept_ranges, "bytes"sv);
+            if (partial) {
+                response.set(http::field::content_range,
+                             "bytes "s + std::to_string(range.offset) + '-' +
+                                 std::to_string(range.offset + range.size - 1) + '/' +
+                                 std::to_string(variant.Size()));
             }
+            send(std::move(response));
+        };
+
+        if (variant.file) {
+            // Content-Length выставляется по диапазону, а на HEAD тело не отправляется
+            auto response =
+                MakeFileResponse(status, {variant.file, range.offset, head ? 0 : range.size},
+                                 version, keep_alive, asset.content_type);
+            response.content_length(range.size);
+            return finish(std::move(response));
         }
-        return true;
+
+        if (!partial) {
+            auto response = MakeSharedResponse(status, head ? nullptr : variant.body, version,
+                                               keep_alive, asset.content_type, variant.etag);
+            response.content_length(range.size);
+            return finish(std::move(response));
+        }
+
+        // Части файлов из памяти невелики: они копируются в тело ответа
+        const std::string_view slice =
+            std::string_view{*variant.body}.substr(range.offset, head ? 0 : range.size);
+        auto response = MakeStringResponse(status, slice, version, keep_alive, asset.content_type);
+        response.content_length(range.size);
+        finish(std::move(response));
     }
 
-   private:
-    const fs::path& root_;
+    // Range выполняется, только если If-Range отсутствует или совпадает с текущей версией:
+    // иначе клиент докачал бы часть другого файла
+    static bool IfRangeMatches(const Fields& headers, const StaticAsset& asset,
+                               const AssetVariant& variant) {
+        auto it = headers.find(http::field::if_range);
+        return it == headers.end() || it->value() == variant.etag ||
+               it->value() == asset.last_modified;
+    }
+
+    // If-Modified-Since сравнивается с Last-Modified как строка: клиент возвращает
+    // значение, полученное от сервера. При наличии If-None-Match он главнее.
+    static bool IsNotModified(const Fields& headers, const StaticAsset& asset,
+                              const AssetVariant& variant) {
+        if (headers.count(http::field::if_none_match)) {
+            return MatchesIfNoneMatch(headers, variant.etag);
+        }
+        auto it = headers.find(http::field::if_modified_since);
+        return it != headers.end() && it->value() == asset.last_modified;
+    }
+
+    template <typename Response>
+    static void SetAssetHeaders(Response& response, const StaticAsset& asset,
+                                ContentCoding coding) {
+        response.set(http::field::last_modified, asset.last_modified);
+        response.set(http::field::vary, "Accept-Encoding"sv);
+        if (coding == ContentCoding::Brotli) {
+            response.set(http::field::content_encoding, "br"sv);
+        } else if (coding == ContentCoding::Gzip) {
+            response.set(http::field::content_encoding, "gzip"sv);
+        }
+    }
+
+    const StaticCache& cache_;
 };
-}  // namespace http_handler
\ No newline at end of file
+}  // namespace http_handler
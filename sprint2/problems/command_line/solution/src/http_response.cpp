@@ -1,13 +1,39 @@
 #include "http_response.h"
 
+#include <algorithm>
 #include <boost/json.hpp>
+#include <charconv>
+#include <type_traits>
 
 namespace http_handler {
 namespace sys = boost::system;
 
+namespace {
+// Ответ, заголовки и тело которого размещаются в ResponseMemory()
+template <typename Response>
+Response MakePooledResponse(http::status status, unsigned http_version) {
+    const Allocator alloc{ResponseMemory()};
+    Response response = [&] {
+        if constexpr (std::is_same_v<typename Response::body_type, StringBody>) {
+            return Response{std::piecewise_construct, std::make_tuple(alloc), std::make_tuple(alloc)};
+        } else {
+            return Response{std::piecewise_construct, std::make_tuple(), std::make_tuple(alloc)};
+        }
+    }();
+    response.result(status);
+    response.version(http_version);
+    return response;
+}
+}  // namespace
+
+std::pmr::memory_resource *ResponseMemory() {
+    static std::pmr::synchronized_pool_resource resource;
+    return &resource;
+}
+
 StringResponse MakeStringResponse(http::status status, std::string_view body, unsigned http_version,
                                   bool keep_alive, std::string_view content_type) {
-    StringResponse response(status, http_version);
+    auto response = MakePooledResponse<StringResponse>(status, http_version);
     response.set(http::field::content_type, content_type);
     response.set(http::field::cache_control, "no-cache");
     response.body() = body;
@@ -16,24 +42,176 @@ StringResponse MakeStringResponse(http::status status, std::string_view body, un
     return response;
 }
 
-FileResponse MakeFileResponse(http::status status, const std::string &file_path,
+FileResponse MakeFileResponse(http::status status, http_server::FileRangeBody::value_type body,
                               unsigned http_version, bool keep_alive,
                               std::string_view content_type) {
-    FileResponse response(status, http_version);
+    auto response = MakePooledResponse<FileResponse>(status, http_version);
     response.set(http::field::content_type, content_type);
+    response.set(http::field::cache_control, "no-cache");
+    response.content_length(body.size);
+    response.body() = std::move(body);
+    response.keep_alive(keep_alive);
+    return response;
+}
 
-    http::file_body::value_type file;
-    if (sys::error_code ec; file.open(file_path.c_str(), beast::file_mode::read, ec), ec) {
-        throw std::runtime_error("Can't open file"s);
-    }
-
-    response.body() = std::move(file);
+SharedResponse MakeSharedResponse(http::status status, std::shared_ptr<const std::string> body,
+                                  unsigned http_version, bool keep_alive,
+                                  std::string_view content_type, std::string_view etag) {
+    auto response = MakePooledResponse<SharedResponse>(status, http_version);
+    response.set(http::field::content_type, content_type);
+    response.set(http::field::cache_control, "no-cache");
+    response.set(http::field::etag, etag);
+    response.content_length(body ? body->size() : 0);
+    response.body() = std::move(body);
     response.keep_alive(keep_alive);
-    response.prepare_payload();
+    return response;
+}
 
+StringResponse MakeNotModified(std::string_view etag, unsigned http_version, bool keep_alive) {
+    auto response = MakePooledResponse<StringResponse>(http::status::not_modified, http_version);
+    response.set(http::field::cache_control, "no-cache");
+    response.set(http::field::etag, etag);
+    response.keep_alive(keep_alive);
     return response;
 }
 
+std::string MakeETag(std::string_view body) {
+    // FNV-1a: значение стабильно между перезапусками сервера
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : body) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string etag(18, '"');
+    for (int i = 16; i >= 1; --i) {
+        etag[i] = kHex[hash & 0xF];
+        hash >>= 4;
+    }
+    return etag;
+}
+
+bool MatchesIfNoneMatch(const Fields& headers, std::string_view etag) {
+    auto it = headers.find(http::field::if_none_match);
+    if (it == headers.end()) {
+        return false;
+    }
+
+    auto strip_weak = [](std::string_view tag) {
+        if (tag.starts_with("W/"sv)) {
+            tag.remove_prefix(2);
+        }
+        return tag;
+    };
+    etag = strip_weak(etag);
+
+    std::string_view value = it->value();
+    while (!value.empty()) {
+        const auto comma = value.find(',');
+        std::string_view tag = value.substr(0, comma);
+        value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+
+        while (!tag.empty() && tag.front() == ' ') tag.remove_prefix(1);
+        while (!tag.empty() && tag.back() == ' ') tag.remove_suffix(1);
+
+        if (tag == "*"sv || strip_weak(tag) == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ListAccepts(std::string_view value, std::string_view token) {
+    auto trim = [](std::string_view s) {
+        while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+        while (!s.empty() && s.back() == ' ') s.remove_suffix(1);
+        return s;
+    };
+
+    while (!value.empty()) {
+        const auto comma = value.find(',');
+        std::string_view range = value.substr(0, comma);
+        value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+
+        const auto semicolon = range.find(';');
+        if (!beast::iequals(trim(range.substr(0, semicolon)), token)) {
+            continue;
+        }
+
+        // q=0 означает, что клиент отказывается от этого варианта
+        std::string_view params =
+            semicolon == std::string_view::npos ? std::string_view{} : range.substr(semicolon + 1);
+        if (const auto q = params.find("q="sv); q != std::string_view::npos) {
+            const std::string_view weight = trim(params.substr(q + 2, params.find(';', q) - q - 2));
+            if (weight.find_first_not_of("0."sv) == std::string_view::npos) {
+                continue;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+BodyEncoding SelectEncoding(const Fields& headers) {
+    auto it = headers.find(http::field::accept);
+    if (it == headers.end() || !ListAccepts(it->value(), ContentType::GAME_BINARY)) {
+        return BodyEncoding::Json;
+    }
+    return BodyEncoding::Binary;
+}
+
+RangeResult ParseRange(std::string_view value, std::uint64_t total, ByteRange& range) {
+    if (value.size() < 6 || !beast::iequals(value.substr(0, 6), "bytes="sv)) {
+        return RangeResult::Full;
+    }
+    value.remove_prefix(6);
+    if (value.find(',') != std::string_view::npos) {
+        return RangeResult::Full;
+    }
+
+    const auto dash = value.find('-');
+    if (dash == std::string_view::npos) {
+        return RangeResult::Full;
+    }
+
+    auto parse = [](std::string_view s, std::uint64_t& number) {
+        const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), number);
+        return !s.empty() && ec == std::errc{} && end == s.data() + s.size();
+    };
+    const std::string_view first = value.substr(0, dash);
+    const std::string_view last = value.substr(dash + 1);
+
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+    if (first.empty()) {
+        // bytes=-n: последние n байт
+        if (!parse(last, end)) {
+            return RangeResult::Full;
+        }
+        if (end == 0 || total == 0) {
+            return RangeResult::Unsatisfiable;
+        }
+        range = {total - std::min(end, total), std::min(end, total)};
+        return RangeResult::Partial;
+    }
+
+    if (!parse(first, begin)) {
+        return RangeResult::Full;
+    }
+    if (last.empty()) {
+        end = total == 0 ? 0 : total - 1;
+    } else if (!parse(last, end) || end < begin) {
+        return RangeResult::Full;
+    }
+    if (begin >= total) {
+        return RangeResult::Unsatisfiable;
+    }
+    end = std::min(end, total - 1);
+    range = {begin, end - begin + 1};
+    return RangeResult::Partial;
+}
+
 StringResponse MakeJsonError(boost::beast::http::status status, std::string_view code,
                              std::string_view message, unsigned version, bool keep_alive) {
     boost::json::object obj;
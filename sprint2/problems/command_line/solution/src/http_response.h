@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 
@@ -24,15 +26,56 @@ struct ContentType {
     constexpr static std::string_view SVG = "image/svg+xml"sv;
     constexpr static std::string_view MP3 = "audio/mpeg"sv;
     constexpr static std::string_view OCTET = "application/octet-stream"sv;
+    // Текстовый формат экспорта Prometheus
+    constexpr static std::string_view PROMETHEUS = "text/plain; version=0.0.4"sv;
+    // Двоичный формат binary_protocol
+    constexpr static std::string_view GAME_BINARY = "application/x-game-binary"sv;
 };
 
+// true, если список вида Accept/Accept-Encoding содержит token с ненулевым весом q
+bool ListAccepts(std::string_view value, std::string_view token);
+
+enum class BodyEncoding { Json, Binary };
+
+// Двоичный формат выбирается, только если клиент явно перечислил его в Accept
+BodyEncoding SelectEncoding(const Fields& headers);
+
+// Общий пул памяти заголовков и тел ответов. Ответы создаются в одних потоках,
+// а уничтожаются в других, поэтому пул синхронизированный.
+std::pmr::memory_resource* ResponseMemory();
+
 StringResponse MakeStringResponse(boost::beast::http::status status, std::string_view body,
                                   unsigned http_version, bool keep_alive,
                                   std::string_view content_type);
 
-FileResponse MakeFileResponse(boost::beast::http::status status, const std::string& file_path,
-                              unsigned http_version, bool keep_alive,
-                              std::string_view content_type);
+FileResponse MakeFileResponse(boost::beast::http::status status,
+                              http_server::FileRangeBody::value_type body, unsigned http_version,
+                              bool keep_alive, std::string_view content_type);
+
+SharedResponse MakeSharedResponse(boost::beast::http::status status,
+                                  std::shared_ptr<const std::string> body, unsigned http_version,
+                                  bool keep_alive, std::string_view content_type,
+                                  std::string_view etag);
+
+StringResponse MakeNotModified(std::string_view etag, unsigned http_version, bool keep_alive);
+
+// Сильный ETag (в кавычках), вычисленный по содержимому тела
+std::string MakeETag(std::string_view body);
+
+// true, если один из тегов заголовка If-None-Match совпадает с etag (слабое сравнение)
+bool MatchesIfNoneMatch(const Fields& headers, std::string_view etag);
+
+struct ByteRange {
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+};
+
+enum class RangeResult { Full, Partial, Unsatisfiable };
+
+// Разбирает заголовок Range для тела размера total. Поддерживается один диапазон
+// (bytes=a-b, bytes=a-, bytes=-n); на несколько диапазонов или ошибку в заголовке
+// возвращается Full, и клиент получает тело целиком.
+RangeResult ParseRange(std::string_view value, std::uint64_t total, ByteRange& range);
 
 StringResponse MakeJsonError(boost::beast::http::status status, std::string_view code,
                              std::string_view message, unsigned version, bool keep_alive);
@@ -1,6 +1,11 @@
 #include "http_server.h"
 
+#include <sys/sendfile.h>
+
+#include <algorithm>
 #include <boost/asio/dispatch.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
+#include <cerrno>
 
 namespace http_server {
 
@@ -10,13 +15,16 @@ void SessionBase::Run() {
 }
 
 void SessionBase::Read() {
-    request_ = {};
+    read_start_ = app_tracing::Now();
+    // Новый запрос берёт память из пула соединения, освобождённую предыдущим
+    request_ = HttpRequest{std::piecewise_construct, std::make_tuple(Allocator{&arena_}),
+                           std::make_tuple(Allocator{&arena_})};
     stream_.expires_after(30s);
     // Считываем request_ из stream_, используя buffer_ для хранения считанных
     // данных
     http::async_read(stream_, buffer_, request_,
                      // По окончании операции будет вызван метод OnRead
-                     beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
+                     BindArena(beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis())));
 }
 
 void SessionBase::OnRead(beast::error_code ec, std::size_t bytes_read) {
@@ -27,10 +35,97 @@ void SessionBase::OnRead(beast::error_code ec, std::size_t bytes_read) {
     if (ec) {
         return ReportError(ec, "read"sv);
     }
+    // Чтение включает ожидание следующего запроса на keep-alive соединении
+    handle_start_ = app_tracing::Now();
+    app_tracing::Record("http.read", read_start_, handle_start_,
+                        static_cast<std::int64_t>(bytes_read), trace_id_);
+
+    if (AcceptsUpgrade() && beast::websocket::is_upgrade(request_)) {
+        // Соединение переходит к обработчику WebSocket вместе с прочитанным запросом
+        stream_.expires_never();
+        return HandleUpgrade(std::move(request_));
+    }
     HandleRequest(std::move(request_));
 }
 
+void SessionBase::OnResponseReady(unsigned status) {
+    write_start_ = app_tracing::Now();
+    app_tracing::Record("http.handle", handle_start_, write_start_, status, trace_id_);
+}
+
+void SessionBase::WriteFile(FileResponse&& response) {
+    auto& file_write = response_.Emplace<FileWrite>(std::move(response));
+    const bool close = file_write.response.need_eof();
+
+    http::async_write_header(
+        stream_, file_write.serializer,
+        BindArena([self = GetSharedThis(), &file_write, close](beast::error_code ec, std::size_t) {
+            if (ec) {
+                return self->OnWrite(close, ec, 0);
+            }
+            self->SendFile(file_write.response.body(), close);
+        }));
+}
+
+void SessionBase::SendFile(FileRangeBody::value_type& body, bool close) {
+    // Ядро копирует файл из page cache прямо в сокет. Когда буфер сокета заполнен,
+    // ждём готовности к записи; offset и size тела отражают ещё не отправленную часть.
+    constexpr std::uint64_t kMaxChunk = 1 << 20;
+
+    auto& socket = stream_.socket();
+    beast::error_code ec;
+    socket.native_non_blocking(true, ec);
+
+    while (!ec && body.size > 0) {
+        off_t offset = static_cast<off_t>(body.offset);
+        const ssize_t sent = ::sendfile(socket.native_handle(), body.file->Get(), &offset,
+                                        std::min(body.size, kMaxChunk));
+        if (sent > 0) {
+            body.offset += static_cast<std::uint64_t>(sent);
+            body.size -= static_cast<std::uint64_t>(sent);
+        } else if (sent == 0) {
+            // Файл укоротился после открытия
+            ec = net::error::eof;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return WaitWritable(body, close);
+        } else if (errno != EINTR) {
+            ec.assign(errno, sys::system_category());
+        }
+    }
+    OnWrite(close, ec, 0);
+}
+
+void SessionBase::WaitWritable(FileRangeBody::value_type& body, bool close) {
+    // Клиент, который перестал читать ответ, не должен держать соединение вечно
+    constexpr auto kSendTimeout = 30s;
+
+    send_timer_.expires_after(kSendTimeout);
+    send_timer_.async_wait(BindArena([self = GetSharedThis()](beast::error_code ec) {
+        // Обработчик мог сработать уже после того, как сокет стал готов и таймер перезапущен
+        if (!ec && self->send_timer_.expiry() <= std::chrono::steady_clock::now()) {
+            self->stream_.socket().cancel();
+        }
+    }));
+    stream_.socket().async_wait(
+        tcp::socket::wait_write,
+        BindArena([self = GetSharedThis(), &body, close](beast::error_code ec) {
+            const bool timed_out = self->send_timer_.expiry() <= std::chrono::steady_clock::now();
+            self->send_timer_.cancel();
+            if (ec == net::error::operation_aborted && timed_out) {
+                ec = beast::error::timeout;
+            }
+            if (ec) {
+                return self->OnWrite(close, ec, 0);
+            }
+            self->SendFile(body, close);
+        }));
+}
+
 void SessionBase::OnWrite(bool close, beast::error_code ec, std::size_t bytes_written) {
+    response_.Reset();
+    app_tracing::Record("http.write", write_start_, app_tracing::Now(),
+                        static_cast<std::int64_t>(bytes_written), trace_id_);
+
     if (ec) {
         return ReportError(ec, "write"sv);
     }
@@ -1,11 +1,17 @@
 #pragma once
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <iostream>
+#include <type_traits>
 
+#include "arena.h"
+#include "file_body.h"
+#include "metrics.h"
 #include "sdk.h"
+#include "tracing.h"
 
 namespace http_server {
 
@@ -17,6 +23,35 @@ namespace http = beast::http;
 
 using namespace std::literals;
 
+// Соединение обслуживается в своём strand. Конкретный тип исполнителя (вместо
+// any_io_executor) не требует выделения памяти при каждом копировании исполнителя.
+using Strand = net::strand<net::io_context::executor_type>;
+using Stream = beast::basic_stream<tcp, Strand>;
+using Socket = Stream::socket_type;
+using Timer = net::basic_waitable_timer<std::chrono::steady_clock,
+                                        net::wait_traits<std::chrono::steady_clock>, Strand>;
+
+// Обработчик завершения, операции которого выделяют память из пула соединения
+template <typename Handler>
+class ArenaHandler {
+   public:
+    using allocator_type = Allocator;
+
+    ArenaHandler(Handler handler, Allocator allocator)
+        : handler_(std::move(handler)), allocator_(allocator) {}
+
+    allocator_type get_allocator() const noexcept { return allocator_; }
+
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+   private:
+    Handler handler_;
+    Allocator allocator_;
+};
+
 inline void ReportError(beast::error_code ec, std::string_view what) {
     std::cerr << what << ": "sv << ec.message() << std::endl;
 }
@@ -29,46 +64,97 @@ class SessionBase {
     void Run();
 
    protected:
-    using HttpRequest = http::request<http::string_body>;
+    using HttpRequest = Request;
+
+    explicit SessionBase(Socket&& socket) : stream_(std::move(socket)) {
+        app_metrics::OnConnectionOpened(app_metrics::Connection::Http);
+    }
 
-    explicit SessionBase(tcp::socket&& socket) : stream_(std::move(socket)) {}
+    // Передаёт соединение другому протоколу; после вызова сессия больше не читает запросы
+    Stream ReleaseStream() { return std::move(stream_); }
+
+    template <typename Handler>
+    ArenaHandler<std::decay_t<Handler>> BindArena(Handler&& handler) {
+        return {std::forward<Handler>(handler), Allocator{&arena_}};
+    }
 
-    template <typename Body, typename Fields>
-    void Write(http::response<Body, Fields>&& response) {
-        // Запись выполняется асинхронно, поэтому response перемещаем в область кучи
-        auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
+    template <typename Body, typename ResponseFields>
+    void Write(http::response<Body, ResponseFields>&& response) {
+        OnResponseReady(response.result_int());
+        if constexpr (std::is_same_v<Body, FileRangeBody>) {
+            WriteFile(std::move(response));
+        } else {
+            // Запись выполняется асинхронно, поэтому ответ хранится в сессии до её окончания
+            using Response = http::response<Body, ResponseFields>;
+            auto& stored = response_.Emplace<Response>(std::move(response));
+            const bool close = stored.need_eof();
 
-        auto self = GetSharedThis();
-        http::async_write(stream_, *safe_response,
-                          [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-                              self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-                          });
+            http::async_write(stream_, stored,
+                              BindArena([self = GetSharedThis(), close](
+                                            beast::error_code ec, std::size_t bytes_written) {
+                                  self->OnWrite(close, ec, bytes_written);
+                              }));
+        }
     }
 
-    ~SessionBase() = default;
+    ~SessionBase() { app_metrics::OnConnectionClosed(app_metrics::Connection::Http); }
 
    private:
+    // Ответ с телом из файла: заголовок пишется сериализатором, тело - через sendfile
+    struct FileWrite {
+        explicit FileWrite(FileResponse&& file_response)
+            : response(std::move(file_response)), serializer(response) {}
+
+        FileResponse response;
+        http::response_serializer<FileRangeBody, Fields> serializer;
+    };
+
     void Read();
     void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
+    void OnResponseReady(unsigned status);
+    void WriteFile(FileResponse&& response);
+    void SendFile(FileRangeBody::value_type& body, bool close);
+    void WaitWritable(FileRangeBody::value_type& body, bool close);
     void OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
     void Close();
 
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
     virtual void HandleRequest(HttpRequest&& request) = 0;
+    virtual bool AcceptsUpgrade() const noexcept = 0;
+    virtual void HandleUpgrade(HttpRequest&& request) = 0;
 
    private:
-    beast::tcp_stream stream_;
+    // Объявлена первой: request_ освобождает память в неё при уничтожении сессии
+    ConnectionArena arena_;
+    Stream stream_;
     beast::flat_buffer buffer_;
-    HttpRequest request_;
+    HttpRequest request_{std::piecewise_construct, std::make_tuple(Allocator{&arena_}),
+                         std::make_tuple(Allocator{&arena_})};
+    ResponseSlot response_;
+    // Ограничивает ожидание готовности сокета в SendFile: оно идёт мимо stream_,
+    // и тайм-аут stream_ его не прерывает
+    Timer send_timer_{stream_.get_executor()};
+
+    // Этапы обработки запроса для трассировки; пока она выключена, отметки нулевые
+    const std::uint64_t trace_id_ = app_tracing::IsEnabled() ? app_tracing::NextAsyncId() : 0;
+    app_tracing::Clock::time_point read_start_;
+    app_tracing::Clock::time_point handle_start_;
+    app_tracing::Clock::time_point write_start_;
 };
 
-template <typename RequestHandler>
-class Session : public SessionBase, public std::enable_shared_from_this<Session<RequestHandler>> {
+// Обработчик Upgrade по умолчанию: такие запросы обслуживаются как обычные HTTP-запросы
+struct NoUpgrade {};
+
+template <typename RequestHandler, typename UpgradeHandler = NoUpgrade>
+class Session : public SessionBase,
+                public std::enable_shared_from_this<Session<RequestHandler, UpgradeHandler>> {
    public:
     template <typename Handler>
-    Session(tcp::socket&& socket, Handler&& request_handler, std::string&& client_ip)
+    Session(Socket&& socket, Handler&& request_handler, UpgradeHandler upgrade_handler,
+            std::string&& client_ip)
         : SessionBase(std::move(socket)),
           request_handler_(std::forward<Handler>(request_handler)),
+          upgrade_handler_(std::move(upgrade_handler)),
           client_ip_(std::move(client_ip)) {}
 
    private:
@@ -82,19 +168,31 @@ class Session : public SessionBase, public std::enable_shared_from_this<Session<
             client_ip_);
     }
 
+    bool AcceptsUpgrade() const noexcept override {
+        return !std::is_same_v<UpgradeHandler, NoUpgrade>;
+    }
+    void HandleUpgrade(HttpRequest&& request) override {
+        if constexpr (!std::is_same_v<UpgradeHandler, NoUpgrade>) {
+            upgrade_handler_(ReleaseStream(), std::move(request), client_ip_);
+        }
+    }
+
    private:
     RequestHandler request_handler_;
+    [[no_unique_address]] UpgradeHandler upgrade_handler_;
     const std::string client_ip_;
 };
 
-template <typename RequestHandler>
-class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
+template <typename RequestHandler, typename UpgradeHandler = NoUpgrade>
+class Listener : public std::enable_shared_from_this<Listener<RequestHandler, UpgradeHandler>> {
    public:
     template <typename Handler>
-    Listener(net::io_context& ioc, tcp::acceptor&& acceptor, Handler&& handler)
+    Listener(net::io_context& ioc, tcp::acceptor&& acceptor, Handler&& handler,
+             UpgradeHandler upgrade_handler = {})
         : ioc_(ioc),
           acceptor_(std::move(acceptor)),
-          request_handler_(std::forward<Handler>(handler)) {}
+          request_handler_(std::forward<Handler>(handler)),
+          upgrade_handler_(std::move(upgrade_handler)) {}
 
     void Run() { DoAccept(); }
 
@@ -105,7 +203,7 @@ class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
             beast::bind_front_handler(&Listener::OnAccept, this->shared_from_this()));
     }
 
-    void OnAccept(sys::error_code ec, tcp::socket socket) {
+    void OnAccept(sys::error_code ec, Socket socket) {
         if (ec) {
             return ReportError(ec, "accept"sv);
         }
@@ -123,9 +221,9 @@ class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
         DoAccept();
     }
 
-    void AsyncRunSession(tcp::socket&& socket, std::string&& client_ip) {
-        std::make_shared<Session<RequestHandler>>(std::move(socket), request_handler_,
-                                                  std::move(client_ip))
+    void AsyncRunSession(Socket&& socket, std::string&& client_ip) {
+        std::make_shared<Session<RequestHandler, UpgradeHandler>>(
+            std::move(socket), request_handler_, upgrade_handler_, std::move(client_ip))
             ->Run();
     }
 
@@ -133,6 +231,7 @@ class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
     RequestHandler request_handler_;
+    UpgradeHandler upgrade_handler_;
 };
 
 template <typename RequestHandler>
@@ -143,4 +242,16 @@ void ServeHttp(net::io_context& ioc, tcp::acceptor&& acceptor, RequestHandler&&
         ->Run();
 }
 
+// Как ServeHttp, но запросы WebSocket Upgrade передаются upgrade_handler вместе с соединением:
+// upgrade_handler(Stream&&, Request&&, const std::string& ip)
+template <typename RequestHandler, typename UpgradeHandler>
+void ServeHttp(net::io_context& ioc, tcp::acceptor&& acceptor, RequestHandler&& handler,
+               UpgradeHandler&& upgrade_handler) {
+    using MyListener = Listener<std::decay_t<RequestHandler>, std::decay_t<UpgradeHandler>>;
+
+    std::make_shared<MyListener>(ioc, std::move(acceptor), std::forward<RequestHandler>(handler),
+                                 std::forward<UpgradeHandler>(upgrade_handler))
+        ->Run();
+}
+
 }  // namespace http_server
@@ -1,13 +1,57 @@
 #pragma once
 
+#include <boost/asio/buffer.hpp>
 #include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <memory>
+#include <string>
+#include <variant>
+
+#include "arena.h"
+#include "file_body.h"
 
 namespace http_handler {
 namespace beast = boost::beast;
 namespace http = beast::http;
 
-using StringRequest = http::request<http::string_body>;
-using StringResponse = http::response<http::string_body>;
-using FileResponse = http::response<http::file_body>;
+// Тело ответа, разделяемое между запросами: при отправке копируется только указатель
+struct SharedStringBody {
+    using value_type = std::shared_ptr<const std::string>;
+
+    static std::uint64_t size(const value_type& body) noexcept { return body ? body->size() : 0; }
+
+    class writer {
+       public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body) : body_(body) {}
+
+        void init(beast::error_code& ec) { ec = {}; }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            if (!body_) {
+                return boost::none;
+            }
+            return {{const_buffers_type{body_->data(), body_->size()}, false}};
+        }
+
+       private:
+        const value_type& body_;
+    };
+};
+
+// Заголовки запросов и ответов размещаются в пулах памяти, а не в куче
+using Allocator = http_server::Allocator;
+using Fields = http_server::Fields;
+using StringBody = http_server::StringBody;
+
+using StringRequest = http_server::Request;
+using StringResponse = http::response<StringBody, Fields>;
+using SharedResponse = http::response<SharedStringBody, Fields>;
+using FileResponse = http_server::FileResponse;
+
+using ApiResponse = std::variant<StringResponse, SharedResponse>;
 
-}  // namespace http_handler
\ No newline at end of file
+}  // namespace http_handler
@@ -48,4 +48,86 @@ boost::json::array GetOfficesFromMap(const model::Map *map) {
     }
     return offices;
 }
+
+boost::json::array GetMapList(const model::Game::Maps &maps) {
+    boost::json::array array;
+    for (const auto &map : maps) {
+        boost::json::object map_obj;
+        map_obj[keys::kId] = *map.GetId();
+        map_obj[keys::kName] = map.GetName();
+        array.push_back(std::move(map_obj));
+    }
+    return array;
+}
+
+boost::json::object GetMapData(const model::Map *map) {
+    boost::json::object map_obj;
+    map_obj[keys::kId] = *map->GetId();
+    map_obj[keys::kName] = map->GetName();
+    map_obj[keys::kRoads] = GetRoadsFromMap(map);
+    map_obj[keys::kBuildings] = GetBuildingsFromMap(map);
+    map_obj[keys::kOffices] = GetOfficesFromMap(map);
+    return map_obj;
+}
+
+namespace {
+boost::json::object DogStateToJson(const model::DogState &dog) {
+    std::string_view dir = "U";
+    switch (dog.direction) {
+        case model::DogDirection::East:
+            dir = "R";
+            break;
+        case model::DogDirection::West:
+            dir = "L";
+            break;
+        case model::DogDirection::North:
+            dir = "U";
+            break;
+        case model::DogDirection::South:
+            dir = "D";
+            break;
+    }
+
+    return {{"pos", boost::json::array{dog.position.x, dog.position.y}},
+            {"speed", boost::json::array{dog.velocity.vx, dog.velocity.vy}},
+            {"dir", dir}};
+}
+}  // namespace
+
+std::string SerializeSessionState(const model::SessionState &state) {
+    boost::json::object players;
+    for (size_t i = 0; i < state.dogs.size(); ++i) {
+        players[std::to_string(state.roster[i].player_id)] = DogStateToJson(state.dogs[i]);
+    }
+
+    boost::json::object out;
+    out["players"] = std::move(players);
+    return boost::json::serialize(out);
+}
+
+std::string SerializeStateFrame(const model::SessionState &state,
+                                const model::SessionState *base) {
+    boost::json::object players;
+    for (size_t i = 0; i < state.dogs.size(); ++i) {
+        if (base && i < base->dogs.size() && base->dogs[i] == state.dogs[i]) {
+            continue;
+        }
+        players[std::to_string(state.roster[i].player_id)] = DogStateToJson(state.dogs[i]);
+    }
+
+    boost::json::object out;
+    out["tick"] = state.tick;
+    out["revision"] = state.revision;
+    out["full"] = base == nullptr;
+    out["players"] = std::move(players);
+    return boost::json::serialize(out);
+}
+
+std::string SerializeRoster(const model::SessionRoster &roster) {
+    boost::json::object out;
+    for (size_t i = 0; i < roster.Size(); ++i) {
+        out[std::to_string(roster[i].player_id)] = {{"name", roster[i].name}};
+    }
+    return boost::json::serialize(out);
+}
 }  // namespace json_serialization
\ No newline at end of file
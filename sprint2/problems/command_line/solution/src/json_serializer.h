@@ -2,9 +2,18 @@
 #include <boost/json.hpp>
 
 #include "model.h"
+#include "session.h"
 
 namespace json_serialization {
 boost::json::array GetRoadsFromMap(const model::Map *map);
 boost::json::array GetBuildingsFromMap(const model::Map *map);
 boost::json::array GetOfficesFromMap(const model::Map *map);
+boost::json::array GetMapList(const model::Game::Maps &maps);
+boost::json::object GetMapData(const model::Map *map);
+std::string SerializeSessionState(const model::SessionState &state);
+// Кадр потока состояния: при base == nullptr - все собаки,
+// иначе только изменившиеся с base и новые
+std::string SerializeStateFrame(const model::SessionState &state,
+                                const model::SessionState *base);
+std::string SerializeRoster(const model::SessionRoster &roster);
 }  // namespace json_serialization
\ No newline at end of file
@@ -1,16 +1,24 @@
 #include "logging.h"
 
+#include <boost/date_time/c_local_time_adjustor.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/core/null_deleter.hpp>
 #include <boost/json.hpp>
 #include <boost/log/core.hpp>
 #include <boost/log/expressions.hpp>
-#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
 #include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/utility/setup/common_attributes.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 
 namespace app_logging {
 
@@ -20,7 +28,270 @@ namespace sinks = boost::log::sinks;
 namespace json = boost::json;
 namespace pt = boost::posix_time;
 
-static void JsonFormatter(logging::record_view const& rec, logging::formatting_ostream& strm) {
+using namespace std::literals;
+
+namespace {
+
+// Строка фиксированной ёмкости: запись журнала копируется в очередь без выделения памяти.
+// Не поместившийся хвост отбрасывается.
+template <std::size_t N>
+class FixedString {
+   public:
+    void Assign(std::string_view s) noexcept {
+        size_ = std::min(s.size(), N);
+        std::memcpy(data_.data(), s.data(), size_);
+    }
+
+    std::string_view View() const noexcept { return {data_.data(), size_}; }
+
+   private:
+    std::array<char, N> data_;
+    std::size_t size_ = 0;
+};
+
+enum class RecordKind : std::uint8_t { Request, Response, Text };
+
+struct Record {
+    RecordKind kind = RecordKind::Text;
+    std::chrono::system_clock::time_point timestamp;
+    std::int64_t response_time_ms = 0;
+    unsigned code = 0;
+    FixedString<46> ip;  // INET6_ADDRSTRLEN
+    FixedString<16> method;
+    FixedString<64> content_type;
+    FixedString<256> uri;
+    std::string text;  // RecordKind::Text: готовая строка с переводом строки
+};
+
+// Ограниченная очередь многих писателей и одного читателя (Д. Вьюков). У каждой ячейки свой
+// номер последовательности, поэтому писатель занимает ячейку одним CAS, а читатель
+// освобождает её одной атомарной записью.
+class RecordRing {
+   public:
+    explicit RecordRing(std::size_t capacity)
+        : cells_{std::make_unique<Cell[]>(capacity)}, capacity_{capacity}, mask_{capacity - 1} {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // false, если очередь заполнена
+    template <typename Fill>
+    bool TryPush(Fill&& fill) {
+        std::uint64_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const std::uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(sequence - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        fill(cell->record);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Вызывается только потоком записи
+    template <typename Consume>
+    bool TryPop(Consume&& consume) {
+        Cell& cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        consume(cell.record);
+        cell.sequence.store(head_ + capacity_, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+   private:
+    struct alignas(64) Cell {
+        std::atomic<std::uint64_t> sequence;
+        Record record;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    const std::size_t capacity_;
+    const std::uint64_t mask_;
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    alignas(64) std::uint64_t head_ = 0;
+};
+
+std::string FormatTimestamp(std::chrono::system_clock::time_point time) {
+    const auto us =
+        std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    const pt::ptime utc = pt::from_time_t(us / 1'000'000) + pt::microseconds(us % 1'000'000);
+    return pt::to_iso_extended_string(boost::date_time::c_local_adjustor<pt::ptime>::utc_to_local(utc));
+}
+
+void AppendJson(const json::value& value, std::string& out) {
+    json::serializer serializer;
+    serializer.reset(&value);
+    char buffer[512];
+    while (!serializer.done()) {
+        out.append(serializer.read(buffer));
+    }
+    out += '\n';
+}
+
+void AppendLine(std::string timestamp, std::string_view message, json::object&& data,
+                std::string& out) {
+    json::object obj{data.storage()};
+    obj["timestamp"] = std::move(timestamp);
+    obj["message"] = message;
+    obj["data"] = std::move(data);
+    AppendJson(obj, out);
+}
+
+// Поток записи забирает записи из очереди, форматирует их и выводит пачками
+// по kBatchSize байт: один вызов write и flush на пачку вместо flush на каждую строку.
+class AsyncWriter {
+   public:
+    explicit AsyncWriter(OverflowPolicy policy) : policy_{policy}, thread_{[this] { Run(); }} {}
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // Дописывает всё, что успели поставить в очередь
+    ~AsyncWriter() {
+        stop_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+
+    template <typename Fill>
+    void Push(Fill&& fill) {
+        Push(std::forward<Fill>(fill), policy_);
+    }
+
+    template <typename Fill>
+    void Push(Fill&& fill, OverflowPolicy policy) {
+        while (!ring_.TryPush(fill)) {
+            if (policy == OverflowPolicy::Drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    LogStats GetStats() const {
+        return {written_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed)};
+    }
+
+   private:
+    static constexpr std::size_t kCapacity = 4096;  // около 2 МБ
+    static constexpr std::size_t kBatchSize = 64 * 1024;
+    static constexpr auto kIdleInterval = 5ms;
+
+    void Run() {
+        std::string batch;
+        batch.reserve(kBatchSize + 4096);
+
+        for (;;) {
+            const bool stopping = stop_.load(std::memory_order_acquire);
+            std::uint64_t count = 0;
+            while (batch.size() < kBatchSize &&
+                   ring_.TryPop([&](Record& record) { Format(record, batch); })) {
+                ++count;
+            }
+            ReportDrops(batch);
+
+            if (!batch.empty()) {
+                std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                std::cout.flush();
+                batch.clear();
+                written_.fetch_add(count, std::memory_order_relaxed);
+                continue;
+            }
+            if (stopping) {
+                return;
+            }
+            std::this_thread::sleep_for(kIdleInterval);
+        }
+    }
+
+    void Format(Record& record, std::string& out) {
+        if (record.kind == RecordKind::Text) {
+            out += record.text;
+            return;
+        }
+
+        // Объекты JSON записи размещаются в буфере на стеке
+        unsigned char buffer[2048];
+        json::monotonic_resource memory{buffer, sizeof(buffer)};
+        json::object data{&memory};
+        data["ip"] = record.ip.View();
+        if (record.kind == RecordKind::Request) {
+            data["URI"] = record.uri.View();
+            data["method"] = record.method.View();
+            AppendLine(FormatTimestamp(record.timestamp), "request received"sv, std::move(data),
+                       out);
+        } else {
+            data["response_time"] = record.response_time_ms;
+            data["code"] = record.code;
+            if (record.content_type.View().empty()) {
+                data["content_type"] = nullptr;
+            } else {
+                data["content_type"] = record.content_type.View();
+            }
+            AppendLine(FormatTimestamp(record.timestamp), "response sent"sv, std::move(data), out);
+        }
+    }
+
+    // Потерянные записи не исчезают бесследно: их число попадает в журнал
+    void ReportDrops(std::string& out) {
+        const std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped == reported_drops_) {
+            return;
+        }
+        json::object data;
+        data["count"] = dropped - reported_drops_;
+        data["total"] = dropped;
+        AppendLine(FormatTimestamp(std::chrono::system_clock::now()), "log records dropped"sv,
+                   std::move(data), out);
+        reported_drops_ = dropped;
+    }
+
+    RecordRing ring_{kCapacity};
+    const OverflowPolicy policy_;
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t reported_drops_ = 0;
+    std::atomic<bool> stop_{false};
+    // Объявлен последним: поток запускается, когда остальные поля уже созданы
+    std::thread thread_;
+};
+
+std::unique_ptr<AsyncWriter>& Writer() {
+    static std::unique_ptr<AsyncWriter> writer;
+    return writer;
+}
+
+// Сообщения Boost.Log форматируются в вызывающем потоке и встают в ту же очередь,
+// чтобы не перемешиваться с журналом запросов
+class RingBackend : public sinks::basic_formatted_sink_backend<char, sinks::concurrent_feeding> {
+   public:
+    void consume(const logging::record_view&, const string_type& line) {
+        if (auto& writer = Writer()) {
+            writer->Push(
+                [&line](Record& record) {
+                    record.kind = RecordKind::Text;
+                    record.text.assign(line);
+                },
+                OverflowPolicy::Block);
+        }
+    }
+};
+
+void JsonFormatter(logging::record_view const& rec, logging::formatting_ostream& strm) {
     json::object obj;
 
     // timestamp
@@ -43,16 +314,14 @@ static void JsonFormatter(logging::record_view const& rec, logging::formatting_o
     strm << json::serialize(obj) << '\n';
 }
 
-void InitLogging() {
-    logging::add_common_attributes();  // TimeStamp и др.
+}  // namespace
 
-    using text_sink = sinks::synchronous_sink<sinks::text_ostream_backend>;
+void InitLogging(OverflowPolicy policy) {
+    logging::add_common_attributes();  // TimeStamp и др.
 
-    auto sink = boost::make_shared<text_sink>();
-    sink->locked_backend()->add_stream(
-        boost::shared_ptr<std::ostream>(&std::cout, boost::null_deleter{}));
-    sink->locked_backend()->auto_flush(true);
+    Writer() = std::make_unique<AsyncWriter>(policy);
 
+    auto sink = boost::make_shared<sinks::synchronous_sink<RingBackend>>();
     sink->set_formatter(&JsonFormatter);
 
     logging::core::get()->remove_all_sinks();
@@ -62,4 +331,37 @@ void InitLogging() {
     logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::info);
 }
 
-}  // namespace app_logging
\ No newline at end of file
+void LogRequest(std::string_view ip, std::string_view uri, std::string_view method) {
+    if (auto& writer = Writer()) {
+        writer->Push([&](Record& record) {
+            record.kind = RecordKind::Request;
+            record.timestamp = std::chrono::system_clock::now();
+            record.ip.Assign(ip);
+            record.uri.Assign(uri);
+            record.method.Assign(method);
+        });
+    }
+}
+
+void LogResponse(std::string_view ip, std::int64_t response_time_ms, unsigned code,
+                 std::string_view content_type) {
+    if (auto& writer = Writer()) {
+        writer->Push([&](Record& record) {
+            record.kind = RecordKind::Response;
+            record.timestamp = std::chrono::system_clock::now();
+            record.response_time_ms = response_time_ms;
+            record.code = code;
+            record.ip.Assign(ip);
+            record.content_type.Assign(content_type);
+        });
+    }
+}
+
+LogStats GetLogStats() {
+    if (auto& writer = Writer()) {
+        return writer->GetStats();
+    }
+    return {};
+}
+
+}  // namespace app_logging
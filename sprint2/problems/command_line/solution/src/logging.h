@@ -2,11 +2,33 @@
 
 #include <boost/json/value.hpp>
 #include <boost/log/expressions/keyword.hpp>
+#include <cstdint>
+#include <string_view>
 
 namespace app_logging {
 
 BOOST_LOG_ATTRIBUTE_KEYWORD(additional_data, "AdditionalData", boost::json::value)
 
-void InitLogging();
+// Что делать с записью журнала запросов, когда очередь записи заполнена
+enum class OverflowPolicy {
+    Drop,  // запись отбрасывается и учитывается в LogStats::dropped
+    Block  // поток обработчика ждёт, пока поток записи освободит место
+};
 
-}  // namespace app_logging
\ No newline at end of file
+// Записи журнала форматируются и выводятся в std::cout отдельным потоком пачками.
+// Сообщения Boost.Log (запуск и остановка сервера) никогда не отбрасываются.
+void InitLogging(OverflowPolicy policy = OverflowPolicy::Drop);
+
+// Журнал запросов: поля копируются в очередь без форматирования и выделения памяти
+void LogRequest(std::string_view ip, std::string_view uri, std::string_view method);
+void LogResponse(std::string_view ip, std::int64_t response_time_ms, unsigned code,
+                 std::string_view content_type);
+
+struct LogStats {
+    std::uint64_t written = 0;
+    std::uint64_t dropped = 0;
+};
+
+LogStats GetLogStats();
+
+}  // namespace app_logging
@@ -1,18 +1,15 @@
 #pragma once
 
 #include <boost/beast/http.hpp>
-#include <boost/json.hpp>
-#include <boost/log/trivial.hpp>
-#include <boost/log/utility/manipulators/add_value.hpp>
 #include <chrono>
 #include <string>
+#include <string_view>
 
 #include "logging.h"
 
 namespace http_handler {
 
 namespace http = boost::beast::http;
-namespace json = boost::json;
 
 inline constexpr const char* kClientIpHeader = "X-Client-IP";
 
@@ -26,12 +23,13 @@ class LoggingRequestHandler {
                     const std::string& ip) {
         const auto start = std::chrono::steady_clock::now();
 
-        LogRequest(req, ip);
+        app_logging::LogRequest(ip, req.target(), req.method_string());
 
         using SendT = std::decay_t<Send>;
         SendT send_copy(std::forward<Send>(send));
 
-        auto wrapped_send = [start, ip, send = std::move(send_copy)](auto&& resp) mutable {
+        // ip принадлежит соединению, которое удерживает send, поэтому строка не копируется
+        auto wrapped_send = [start, &ip, send = std::move(send_copy)](auto&& resp) mutable {
             LogResponse(ip, start, resp);
             send(std::forward<decltype(resp)>(resp));
         };
@@ -40,18 +38,6 @@ class LoggingRequestHandler {
     }
 
    private:
-    template <typename Req>
-    static void LogRequest(const Req& req, const std::string& ip) {
-        json::object data;
-        data["ip"] = ip;
-        data["URI"] = std::string(req.target());
-        data["method"] = std::string(req.method_string());
-
-        BOOST_LOG_TRIVIAL(info) << boost::log::add_value(app_logging::additional_data,
-                                                         json::value(std::move(data)))
-                                << "request received";
-    }
-
     template <typename Resp>
     static void LogResponse(const std::string& ip, std::chrono::steady_clock::time_point start,
                             const Resp& resp) {
@@ -59,20 +45,9 @@ class LoggingRequestHandler {
                             std::chrono::steady_clock::now() - start)
                             .count();
 
-        json::object data;
-        data["ip"] = ip;
-        data["response_time"] = static_cast<std::int64_t>(ms);
-        data["code"] = resp.result_int();
-
         auto ct_it = resp.find(http::field::content_type);
-        if (ct_it == resp.end())
-            data["content_type"] = nullptr;
-        else
-            data["content_type"] = std::string(ct_it->value());
-
-        BOOST_LOG_TRIVIAL(info) << boost::log::add_value(app_logging::additional_data,
-                                                         json::value(std::move(data)))
-                                << "response sent";
+        app_logging::LogResponse(ip, static_cast<std::int64_t>(ms), resp.result_int(),
+                                 ct_it == resp.end() ? std::string_view{} : ct_it->value());
     }
 
    private:
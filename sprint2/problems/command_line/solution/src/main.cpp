@@ -1,12 +1,17 @@
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/json.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/log/utility/manipulators/add_value.hpp>
 #include <boost/program_options.hpp>
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <boost/program_options/value_semantic.hpp>
 #include <chrono>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <optional>
 #include <stdexcept>
@@ -17,9 +22,13 @@
 #include "json_loader.h"
 #include "logging.h"
 #include "logging_request_handler.h"
+#include "metrics_request_handler.h"
 #include "request_handler.h"
 #include "sdk.h"
+#include "static_cache.h"
+#include "state_stream.h"
 #include "ticker.h"
+#include "tracing.h"
 
 using namespace std::literals;
 namespace net = boost::asio;
@@ -41,6 +50,41 @@ void RunWorkers(unsigned n, const Fn &fn) {
     fn();
 }
 
+// По SIGUSR1 записывает накопленные события трассировки в path. Файл пишется под временным
+// именем и затем переименовывается, поэтому не бывает виден недописанным.
+void DumpTraceOnSignal(net::signal_set &signals, const std::filesystem::path &path) {
+    signals.async_wait([&signals, path](const sys::error_code &ec, int) {
+        if (ec) {
+            return;
+        }
+
+        auto tmp_path = path;
+        tmp_path += ".tmp"s;
+        std::error_code fs_ec;
+        {
+            std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+            app_tracing::WriteChromeTrace(out);
+            if (!out) {
+                fs_ec = std::make_error_code(std::errc::io_error);
+            }
+        }
+        if (!fs_ec) {
+            std::filesystem::rename(tmp_path, path, fs_ec);
+        }
+
+        boost::json::object data;
+        data["file"] = path.string();
+        if (fs_ec) {
+            data["error"] = fs_ec.message();
+        }
+        BOOST_LOG_TRIVIAL(info) << boost::log::add_value(app_logging::additional_data,
+                                                         boost::json::value(std::move(data)))
+                                << "trace written"sv;
+
+        DumpTraceOnSignal(signals, path);
+    });
+}
+
 }  // namespace
 
 struct Args {
@@ -48,6 +92,9 @@ struct Args {
     std::string config_file;
     std::string www_root;
     bool randomize_spawn_points = false;
+    Ticker::Mode tick_mode = Ticker::Mode::Elastic;
+    bool watch_www_root = false;
+    std::string trace_file;
 };
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char *argv[]) {
@@ -58,10 +105,17 @@ struct Args {
     po::options_description desc{"Allowed options"s};
     desc.add_options()("help,h", "produce help message")(
         "tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"),
-        "set tick period")("config-file,c", po::value(&args.config_file)->value_name("file"),
-                           "set config file path")(
+        "set tick period")(
+        "tick-mode", po::value<std::string>()->value_name("elastic|fixed"),
+        "elastic: tick after the previous one finished (default); "
+        "fixed: keep a fixed schedule and catch up missed ticks")(
+        "config-file,c", po::value(&args.config_file)->value_name("file"),
+        "set config file path")(
         "www-root,w", po::value(&args.www_root)->value_name("dir"), "set static files root")(
-        "randomize-spawn-points", "spawn dogs at random positions");
+        "randomize-spawn-points", "spawn dogs at random positions")(
+        "watch-www-root", "reload static files when they change")(
+        "trace-file", po::value(&args.trace_file)->value_name("file"),
+        "record request and tick spans; write them to file in Chrome trace format on SIGUSR1");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -82,6 +136,17 @@ struct Args {
     if (vm.contains("randomize-spawn-points"s)) {
         args.randomize_spawn_points = true;
     }
+    if (vm.contains("tick-mode"s)) {
+        const auto &mode = vm["tick-mode"s].as<std::string>();
+        if (mode == "fixed"sv) {
+            args.tick_mode = Ticker::Mode::Fixed;
+        } else if (mode != "elastic"sv) {
+            throw std::runtime_error("Unknown tick mode: "s + mode);
+        }
+    }
+    if (vm.contains("watch-www-root"s)) {
+        args.watch_www_root = true;
+    }
 
     return args;
 }
@@ -111,17 +176,37 @@ int main(int argc, const char *argv[]) {
                 std::cerr << "Invalid doc_root: " << args->www_root << "\n";
                 return EXIT_FAILURE;
             }
+            http_handler::StaticCache static_cache{doc_root};
+            net::signal_set trace_signals(ioc);
+            if (!args->trace_file.empty()) {
+                app_tracing::Enable();
+                trace_signals.add(SIGUSR1);
+                DumpTraceOnSignal(trace_signals, args->trace_file);
+            }
+
+            if (args->watch_www_root) {
+                static_cache.WatchChanges(ioc);
+            }
 
             auto ms = std::chrono::milliseconds{args->tick_period};
             bool autotick = (args->tick_period > 0);
-            app::Application application(std::move(game), args->randomize_spawn_points, autotick);
+            app::Application application(std::move(game), args->randomize_spawn_points, autotick,
+                                         num_threads);
             auto api_starnd = net::make_strand(ioc);
-            auto ticker = std::make_shared<Ticker>(
-                api_starnd, ms,
-                [&application](std::chrono::milliseconds delta) { application.Tick(delta); });
-            http_handler::RequestHandler handler{std::move(api_starnd), application, doc_root};
-            http_handler::LoggingRequestHandler<http_handler::RequestHandler> logging_handler{
+            std::shared_ptr<Ticker> ticker;
+            if (autotick) {
+                ticker = std::make_shared<Ticker>(
+                    api_starnd, ms,
+                    [&application](std::chrono::milliseconds delta) { application.Tick(delta); },
+                    args->tick_mode);
+            }
+            http_handler::RequestHandler handler{std::move(api_starnd), application,
+                                                 static_cache};
+            http_handler::MetricsRequestHandler<http_handler::RequestHandler> metrics_handler{
                 handler};
+            http_handler::LoggingRequestHandler<decltype(metrics_handler)> logging_handler{
+                metrics_handler};
+            http_handler::StateStreamHandler stream_handler{application};
 
             const int port = 8080;
             const auto address = net::ip::make_address("0.0.0.0");
@@ -147,13 +232,16 @@ int main(int argc, const char *argv[]) {
                     << "server started"sv;
             }
 
-            ticker->Start();
+            if (ticker) {
+                ticker->Start();
+            }
             http_server::ServeHttp(
                 ioc, std::move(acceptor),
                 [&logging_handler](auto &&req, auto &&send, const std::string& client_ip) {
                     logging_handler(std::forward<decltype(req)>(req),
                                     std::forward<decltype(send)>(send), client_ip);
-                });
+                },
+                stream_handler);
 
             RunWorkers(std::max(1u, num_threads), [&ioc] { ioc.run(); });
 
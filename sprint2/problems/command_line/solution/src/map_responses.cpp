@@ -0,0 +1,38 @@
+#include "map_responses.h"
+
+#include <boost/json.hpp>
+
+#include "binary_codec.h"
+#include "http_response.h"
+#include "json_serializer.h"
+
+namespace http_handler {
+namespace {
+PreparedBody Prepare(std::string body) {
+    std::string etag = MakeETag(body);
+    return {std::make_shared<const std::string>(std::move(body)), std::move(etag)};
+}
+
+PreparedBody Prepare(const boost::json::value& value) {
+    return Prepare(boost::json::serialize(value));
+}
+}  // namespace
+
+MapResponses::MapResponses(const model::Game::Maps& maps)
+    : map_list_(Prepare(json_serialization::GetMapList(maps))) {
+    for (const auto& map : maps) {
+        maps_.emplace(*map.GetId(),
+                      MapBodies{Prepare(json_serialization::GetMapData(&map)),
+                                Prepare(binary_protocol::EncodeMap(map))});
+    }
+}
+
+const PreparedBody* MapResponses::FindMap(std::string_view id,
+                                          BodyEncoding encoding) const noexcept {
+    if (auto it = maps_.find(id); it != maps_.end()) {
+        return encoding == BodyEncoding::Binary ? &it->second.binary : &it->second.json;
+    }
+    return nullptr;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "http_response.h"
+#include "model.h"
+
+namespace http_handler {
+
+// Тело ответа, подготовленное заранее, вместе с его ETag
+struct PreparedBody {
+    std::shared_ptr<const std::string> body;
+    std::string etag;
+};
+
+// Ответы /api/v1/maps и /api/v1/maps/{id}. Карты не меняются после загрузки,
+// поэтому JSON и двоичное представление строятся один раз при старте сервера.
+class MapResponses {
+   public:
+    explicit MapResponses(const model::Game::Maps& maps);
+
+    const PreparedBody& GetMapList() const noexcept { return map_list_; }
+
+    const PreparedBody* FindMap(std::string_view id, BodyEncoding encoding) const noexcept;
+
+   private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    struct MapBodies {
+        PreparedBody json;
+        PreparedBody binary;
+    };
+
+    PreparedBody map_list_;
+    std::unordered_map<std::string, MapBodies, StringHash, std::equal_to<>> maps_;
+};
+
+}  // namespace http_handler
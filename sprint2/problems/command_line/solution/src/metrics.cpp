@@ -0,0 +1,424 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "logging.h"
+
+namespace app_metrics {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::size_t kRouteCount = static_cast<std::size_t>(Route::Other) + 1;
+constexpr std::size_t kStatusClassCount = 5;  // 1xx .. 5xx
+constexpr std::size_t kConnectionCount = static_cast<std::size_t>(Connection::WebSocket) + 1;
+constexpr std::size_t kGaugeCount = static_cast<std::size_t>(Gauge::Players) + 1;
+
+constexpr std::array<std::string_view, kRouteCount> kRouteNames = {
+    "maps"sv, "map"sv, "join"sv, "players"sv, "state"sv,
+    "action"sv, "tick"sv, "metrics"sv, "static"sv, "other"sv};
+constexpr std::array<std::string_view, kStatusClassCount> kStatusClassNames = {
+    "1xx"sv, "2xx"sv, "3xx"sv, "4xx"sv, "5xx"sv};
+constexpr std::array<std::string_view, kConnectionCount> kConnectionNames = {"http"sv,
+                                                                             "websocket"sv};
+
+// Счётчик, в который пишет только поток-владелец. Обычная запись вместо атомарного
+// сложения не блокирует шину, а читатель видит целое, пусть и чуть устаревшее значение.
+class Counter {
+   public:
+    void Add(std::uint64_t n) noexcept {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    std::uint64_t Load() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+// Гистограмма в духе HdrHistogram: значения до 16 мкс хранятся точно, дальше каждая степень
+// двойки делится на 8 корзин. Относительная погрешность не больше 12.5% до 2^32 мкс (~71 мин).
+class Histogram {
+   public:
+    static constexpr std::size_t kExactBuckets = 16;
+    static constexpr std::size_t kSubBuckets = 8;
+    static constexpr unsigned kMaxExponent = 31;
+    static constexpr std::size_t kBucketCount = kExactBuckets + (kMaxExponent - 3) * kSubBuckets;
+
+    static std::size_t BucketIndex(std::uint64_t value) noexcept {
+        value = std::min<std::uint64_t>(value, (std::uint64_t{1} << (kMaxExponent + 1)) - 1);
+        if (value < kExactBuckets) {
+            return static_cast<std::size_t>(value);
+        }
+        const unsigned exponent = std::bit_width(value) - 1;
+        const std::uint64_t mantissa = value >> (exponent - 3);  // 8 .. 15
+        return kExactBuckets + (exponent - 4) * kSubBuckets + (mantissa - kSubBuckets);
+    }
+
+    // Наибольшее значение, попадающее в корзину
+    static std::uint64_t BucketUpperBound(std::size_t index) noexcept {
+        if (index < kExactBuckets) {
+            return index;
+        }
+        const unsigned exponent = 4 + static_cast<unsigned>((index - kExactBuckets) / kSubBuckets);
+        const std::uint64_t mantissa = kSubBuckets + (index - kExactBuckets) % kSubBuckets;
+        return ((mantissa + 1) << (exponent - 3)) - 1;
+    }
+
+    void Record(std::uint64_t value) noexcept {
+        buckets_[BucketIndex(value)].Add(1);
+        sum_.Add(value);
+    }
+
+    std::uint64_t Bucket(std::size_t index) const noexcept { return buckets_[index].Load(); }
+    std::uint64_t Sum() const noexcept { return sum_.Load(); }
+
+   private:
+    std::array<Counter, kBucketCount> buckets_;
+    Counter sum_;
+};
+
+struct HistogramSnapshot {
+    std::array<std::uint64_t, Histogram::kBucketCount> buckets{};
+    std::uint64_t sum = 0;
+    std::uint64_t count = 0;
+
+    void Add(const Histogram& histogram) {
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            const std::uint64_t n = histogram.Bucket(i);
+            buckets[i] += n;
+            count += n;
+        }
+        sum += histogram.Sum();
+    }
+
+    std::uint64_t Quantile(double q) const {
+        const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count) + 0.5);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= std::max<std::uint64_t>(rank, 1)) {
+                return Histogram::BucketUpperBound(i);
+            }
+        }
+        return 0;
+    }
+};
+
+struct ThreadSlot {
+    std::array<std::array<Counter, kStatusClassCount>, kRouteCount> requests;
+    std::array<Histogram, kRouteCount> latency;
+    Histogram tick_duration;
+    Histogram tick_lag;
+    Counter ticks;
+    Counter ticks_late;
+    Counter ticks_skipped;
+    Counter strand_enqueued;
+    Counter strand_dequeued;
+    std::array<Counter, kConnectionCount> connections_opened;
+    std::array<Counter, kConnectionCount> connections_closed;
+};
+
+// Счётчики всех потоков. Поток регистрирует свой набор при первой записи;
+// наборы не удаляются, поэтому накопленное завершившимися потоками не теряется.
+class Registry {
+   public:
+    ThreadSlot& Register() {
+        auto slot = std::make_unique<ThreadSlot>();
+        std::lock_guard lock{mutex_};
+        return *slots_.emplace_back(std::move(slot));
+    }
+
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        std::lock_guard lock{mutex_};
+        for (const auto& slot : slots_) {
+            fn(*slot);
+        }
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadSlot>> slots_;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+ThreadSlot& LocalSlot() {
+    thread_local ThreadSlot& slot = GetRegistry().Register();
+    return slot;
+}
+
+std::array<std::atomic<std::int64_t>, kGaugeCount> gauges{};
+
+std::uint64_t ToMicroseconds(std::chrono::nanoseconds duration) {
+    return duration.count() <= 0 ? 0 : static_cast<std::uint64_t>(duration.count() / 1000);
+}
+
+struct Snapshot {
+    std::array<std::array<std::uint64_t, kStatusClassCount>, kRouteCount> requests{};
+    std::array<HistogramSnapshot, kRouteCount> latency;
+    HistogramSnapshot tick_duration;
+    HistogramSnapshot tick_lag;
+    std::uint64_t ticks = 0;
+    std::uint64_t ticks_late = 0;
+    std::uint64_t ticks_skipped = 0;
+    std::uint64_t strand_enqueued = 0;
+    std::uint64_t strand_dequeued = 0;
+    std::array<std::uint64_t, kConnectionCount> connections_opened{};
+    std::array<std::uint64_t, kConnectionCount> connections_closed{};
+};
+
+Snapshot Collect() {
+    Snapshot snapshot;
+    GetRegistry().ForEach([&snapshot](const ThreadSlot& slot) {
+        for (std::size_t route = 0; route < kRouteCount; ++route) {
+            for (std::size_t status = 0; status < kStatusClassCount; ++status) {
+                snapshot.requests[route][status] += slot.requests[route][status].Load();
+            }
+            snapshot.latency[route].Add(slot.latency[route]);
+        }
+        snapshot.tick_duration.Add(slot.tick_duration);
+        snapshot.tick_lag.Add(slot.tick_lag);
+        snapshot.ticks += slot.ticks.Load();
+        snapshot.ticks_late += slot.ticks_late.Load();
+        snapshot.ticks_skipped += slot.ticks_skipped.Load();
+        snapshot.strand_enqueued += slot.strand_enqueued.Load();
+        snapshot.strand_dequeued += slot.strand_dequeued.Load();
+        for (std::size_t i = 0; i < kConnectionCount; ++i) {
+            snapshot.connections_opened[i] += slot.connections_opened[i].Load();
+            snapshot.connections_closed[i] += slot.connections_closed[i].Load();
+        }
+    });
+    return snapshot;
+}
+
+template <typename Number>
+void AppendNumber(std::string& out, Number value) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendSeconds(std::string& out, std::uint64_t microseconds) {
+    AppendNumber(out, static_cast<double>(microseconds) / 1e6);
+}
+
+void AppendFamily(std::string& out, std::string_view name, std::string_view type,
+                  std::string_view help) {
+    out.append("# HELP "sv).append(name).append(" "sv).append(help).append("\n"sv);
+    out.append("# TYPE "sv).append(name).append(" "sv).append(type).append("\n"sv);
+}
+
+// name{labels,extra} - пустые части меток пропускаются
+void AppendSeriesName(std::string& out, std::string_view name, std::string_view labels,
+                      std::string_view extra = {}) {
+    out.append(name);
+    if (labels.empty() && extra.empty()) {
+        return;
+    }
+    out += '{';
+    out.append(labels);
+    if (!labels.empty() && !extra.empty()) {
+        out += ',';
+    }
+    out.append(extra);
+    out += '}';
+}
+
+template <typename Number>
+void AppendSample(std::string& out, std::string_view name, std::string_view labels,
+                  Number value) {
+    AppendSeriesName(out, name, labels);
+    out += ' ';
+    AppendNumber(out, value);
+    out += '\n';
+}
+
+// Границы le экспортируются по степеням двойки от 16 мкс до ~33 с
+void AppendHistogram(std::string& out, std::string_view name, std::string_view labels,
+                     const HistogramSnapshot& histogram) {
+    const std::string bucket = std::string(name) + "_bucket";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < Histogram::kBucketCount; ++i) {
+        cumulative += histogram.buckets[i];
+        const std::uint64_t bound = Histogram::BucketUpperBound(i) + 1;
+        if (!std::has_single_bit(bound) || bound < Histogram::kExactBuckets || bound > (1u << 25)) {
+            continue;
+        }
+        std::string le = "le=\"";
+        AppendSeconds(le, bound);
+        le += '"';
+        AppendSeriesName(out, bucket, labels, le);
+        out += ' ';
+        AppendNumber(out, cumulative);
+        out += '\n';
+    }
+    AppendSeriesName(out, bucket, labels, "le=\"+Inf\""sv);
+    out += ' ';
+    AppendNumber(out, histogram.count);
+    out += '\n';
+
+    AppendSeriesName(out, std::string(name) + "_sum", labels);
+    out += ' ';
+    AppendSeconds(out, histogram.sum);
+    out += '\n';
+    AppendSample(out, std::string(name) + "_count", labels, histogram.count);
+}
+
+void AppendQuantiles(std::string& out, std::string_view name, std::string_view labels,
+                     const HistogramSnapshot& histogram) {
+    for (const auto [q, text] : {std::pair{0.5, "0.5"sv}, std::pair{0.9, "0.9"sv},
+                                 std::pair{0.99, "0.99"sv}, std::pair{0.999, "0.999"sv}}) {
+        AppendSeriesName(out, name, labels, "quantile=\""s.append(text) + '"');
+        out += ' ';
+        AppendSeconds(out, histogram.Quantile(q));
+        out += '\n';
+    }
+}
+
+std::string RouteLabel(std::size_t route) {
+    return "route=\""s.append(kRouteNames[route]) + '"';
+}
+
+}  // namespace
+
+void RecordRequest(Route route, unsigned status, std::chrono::nanoseconds latency) {
+    auto& slot = LocalSlot();
+    const auto index = static_cast<std::size_t>(route);
+    const std::size_t status_class = std::clamp<unsigned>(status / 100, 1, 5) - 1;
+    slot.requests[index][status_class].Add(1);
+    slot.latency[index].Record(ToMicroseconds(latency));
+}
+
+void RecordTick(std::chrono::nanoseconds duration, std::chrono::nanoseconds lag) {
+    auto& slot = LocalSlot();
+    slot.tick_duration.Record(ToMicroseconds(duration));
+    slot.tick_lag.Record(ToMicroseconds(lag));
+}
+
+void RecordTickSchedule(std::uint64_t steps, std::uint64_t late, std::uint64_t skipped) {
+    auto& slot = LocalSlot();
+    slot.ticks.Add(steps);
+    slot.ticks_late.Add(late);
+    slot.ticks_skipped.Add(skipped);
+}
+
+void OnStrandEnqueued() { LocalSlot().strand_enqueued.Add(1); }
+void OnStrandDequeued() { LocalSlot().strand_dequeued.Add(1); }
+
+void OnConnectionOpened(Connection connection) {
+    LocalSlot().connections_opened[static_cast<std::size_t>(connection)].Add(1);
+}
+void OnConnectionClosed(Connection connection) {
+    LocalSlot().connections_closed[static_cast<std::size_t>(connection)].Add(1);
+}
+
+void SetGauge(Gauge gauge, std::int64_t value) {
+    gauges[static_cast<std::size_t>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+std::string RenderPrometheus() {
+    const Snapshot snapshot = Collect();
+    std::string out;
+    out.reserve(32 * 1024);
+
+    AppendFamily(out, "game_http_requests_total"sv, "counter"sv,
+                 "HTTP requests by route and status class."sv);
+    for (std::size_t route = 0; route < kRouteCount; ++route) {
+        for (std::size_t status = 0; status < kStatusClassCount; ++status) {
+            if (const auto n = snapshot.requests[route][status]) {
+                const std::string labels = RouteLabel(route) + ",code=\"" +
+                                           std::string(kStatusClassNames[status]) + '"';
+                AppendSample(out, "game_http_requests_total"sv, labels, n);
+            }
+        }
+    }
+
+    AppendFamily(out, "game_http_request_duration_seconds"sv, "histogram"sv,
+                 "Time from reading a request to handing its response to the connection."sv);
+    for (std::size_t route = 0; route < kRouteCount; ++route) {
+        if (snapshot.latency[route].count) {
+            AppendHistogram(out, "game_http_request_duration_seconds"sv, RouteLabel(route),
+                            snapshot.latency[route]);
+        }
+    }
+
+    AppendFamily(out, "game_http_request_latency_seconds"sv, "summary"sv,
+                 "Request latency quantiles at microsecond resolution."sv);
+    for (std::size_t route = 0; route < kRouteCount; ++route) {
+        if (const auto& latency = snapshot.latency[route]; latency.count) {
+            const std::string labels = RouteLabel(route);
+            AppendQuantiles(out, "game_http_request_latency_seconds"sv, labels, latency);
+            AppendSeriesName(out, "game_http_request_latency_seconds_sum"sv, labels);
+            out += ' ';
+            AppendSeconds(out, latency.sum);
+            out += '\n';
+            AppendSample(out, "game_http_request_latency_seconds_count"sv, labels, latency.count);
+        }
+    }
+
+    AppendFamily(out, "game_tick_duration_seconds"sv, "histogram"sv,
+                 "Time spent advancing all game sessions by one tick."sv);
+    AppendHistogram(out, "game_tick_duration_seconds"sv, {}, snapshot.tick_duration);
+
+    AppendFamily(out, "game_tick_lag_seconds"sv, "histogram"sv,
+                 "How late a tick started relative to its schedule."sv);
+    AppendHistogram(out, "game_tick_lag_seconds"sv, {}, snapshot.tick_lag);
+
+    AppendFamily(out, "game_ticks_total"sv, "counter"sv, "Game ticks applied to the model."sv);
+    AppendSample(out, "game_ticks_total"sv, {}, snapshot.ticks);
+    AppendFamily(out, "game_ticks_late_total"sv, "counter"sv,
+                 "Ticks that ran after the next tick was already due (catch-up steps)."sv);
+    AppendSample(out, "game_ticks_late_total"sv, {}, snapshot.ticks_late);
+    AppendFamily(out, "game_ticks_skipped_total"sv, "counter"sv,
+                 "Ticks dropped because catch-up was capped."sv);
+    AppendSample(out, "game_ticks_skipped_total"sv, {}, snapshot.ticks_skipped);
+
+    AppendFamily(out, "game_app_strand_queue_depth"sv, "gauge"sv,
+                 "Requests waiting for the application strand."sv);
+    AppendSample(out, "game_app_strand_queue_depth"sv, {},
+                 static_cast<std::int64_t>(snapshot.strand_enqueued - snapshot.strand_dequeued));
+
+    AppendFamily(out, "game_connections_active"sv, "gauge"sv, "Open client connections."sv);
+    for (std::size_t i = 0; i < kConnectionCount; ++i) {
+        AppendSample(out, "game_connections_active"sv,
+                     "kind=\""s.append(kConnectionNames[i]) + '"',
+                     static_cast<std::int64_t>(snapshot.connections_opened[i] -
+                                               snapshot.connections_closed[i]));
+    }
+    AppendFamily(out, "game_connections_total"sv, "counter"sv, "Accepted client connections."sv);
+    for (std::size_t i = 0; i < kConnectionCount; ++i) {
+        AppendSample(out, "game_connections_total"sv,
+                     "kind=\""s.append(kConnectionNames[i]) + '"', snapshot.connections_opened[i]);
+    }
+
+    AppendFamily(out, "game_sessions"sv, "gauge"sv, "Game sessions."sv);
+    AppendSample(out, "game_sessions"sv, {},
+                 gauges[static_cast<std::size_t>(Gauge::Sessions)].load(std::memory_order_relaxed));
+    AppendFamily(out, "game_players"sv, "gauge"sv, "Players that joined the game."sv);
+    AppendSample(out, "game_players"sv, {},
+                 gauges[static_cast<std::size_t>(Gauge::Players)].load(std::memory_order_relaxed));
+
+    const auto log_stats = app_logging::GetLogStats();
+    AppendFamily(out, "game_log_records_written_total"sv, "counter"sv,
+                 "Log records written to stdout."sv);
+    AppendSample(out, "game_log_records_written_total"sv, {}, log_stats.written);
+    AppendFamily(out, "game_log_records_dropped_total"sv, "counter"sv,
+                 "Log records dropped because the log queue was full."sv);
+    AppendSample(out, "game_log_records_dropped_total"sv, {}, log_stats.dropped);
+
+    return out;
+}
+
+}  // namespace app_metrics
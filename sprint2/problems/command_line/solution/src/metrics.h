@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Метрики сервера в формате Prometheus. Счётчики ведутся отдельно в каждом потоке
+// без блокировок и складываются только при чтении /metrics.
+namespace app_metrics {
+
+// Группы запросов, для которых ведётся отдельная статистика
+enum class Route : std::uint8_t {
+    Maps,
+    Map,
+    Join,
+    Players,
+    State,
+    Action,
+    Tick,
+    Metrics,
+    Static,
+    Other  // последний: по нему считается число групп
+};
+
+enum class Connection : std::uint8_t { Http, WebSocket };
+
+// Значения, которые меняются в strand приложения и публикуются целиком
+enum class Gauge : std::uint8_t { Sessions, Players };
+
+void RecordRequest(Route route, unsigned status, std::chrono::nanoseconds latency);
+
+// duration - время обработки тика, lag - насколько тик начался позже запланированного
+void RecordTick(std::chrono::nanoseconds duration, std::chrono::nanoseconds lag);
+
+// Тики за одно срабатывание таймера: steps - выполнено, late - из них догоняющих (их срок
+// прошёл раньше предыдущего срабатывания), skipped - пропущено. Пропущенные не входят в late
+void RecordTickSchedule(std::uint64_t steps, std::uint64_t late, std::uint64_t skipped);
+
+// Запросы, ожидающие strand приложения: глубина очереди = поставленные - начатые
+void OnStrandEnqueued();
+void OnStrandDequeued();
+
+void OnConnectionOpened(Connection connection);
+void OnConnectionClosed(Connection connection);
+
+void SetGauge(Gauge gauge, std::int64_t value);
+
+// Текстовый формат экспорта Prometheus 0.0.4
+std::string RenderPrometheus();
+
+}  // namespace app_metrics
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <string_view>
+#include <utility>
+
+#include "metrics.h"
+#include "url_utils.h"
+
+namespace http_handler {
+
+namespace http = boost::beast::http;
+
+// Группа запроса для статистики; параметры запроса не учитываются
+inline app_metrics::Route RouteOf(std::string_view target) {
+    using app_metrics::Route;
+
+    const std::string_view path = url::SplitQuery(target).first;
+    if (path == Endpoint::MAPS) return Route::Maps;
+    if (url::ExtractMapId(path)) return Route::Map;
+    if (path == Endpoint::JOIN) return Route::Join;
+    if (path == Endpoint::PLAYERS) return Route::Players;
+    if (path == Endpoint::STATE) return Route::State;
+    if (path == Endpoint::ACTION) return Route::Action;
+    if (path == Endpoint::TICK) return Route::Tick;
+    if (path == Endpoint::METRICS) return Route::Metrics;
+    if (url::IsApi(path)) return Route::Other;
+    return Route::Static;
+}
+
+// Считает запросы и время их обработки: от получения запроса до передачи ответа соединению
+template <class DecoratedHandler>
+class MetricsRequestHandler {
+   public:
+    explicit MetricsRequestHandler(DecoratedHandler& decorated) : decorated_(decorated) {}
+
+    template <typename Body, typename Allocator, typename Send>
+    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto route = RouteOf(req.target());
+
+        using SendT = std::decay_t<Send>;
+        auto measured_send = [start, route, send = SendT(std::forward<Send>(send))](
+                                 auto&& resp) mutable {
+            app_metrics::RecordRequest(route, resp.result_int(),
+                                       std::chrono::steady_clock::now() - start);
+            send(std::forward<decltype(resp)>(resp));
+        };
+
+        decorated_(std::move(req), std::move(measured_send));
+    }
+
+   private:
+    DecoratedHandler& decorated_;
+};
+
+}  // namespace http_handler
@@ -10,89 +10,38 @@ namespace model {
 using namespace std::literals;
 
 const Road* Map::FindRoadAt(DogPos pos) const {
-    auto h_lower =
-        std::lower_bound(horizontal_roads_.begin(), horizontal_roads_.end(), pos.y - Road::WIDTH,
-                         [](const RoadSegment& seg, double y) { return seg.fixed_coord < y; });
-
-    for (auto it = h_lower; it != horizontal_roads_.end(); ++it) {
-        if (it->fixed_coord > pos.y + Road::WIDTH) break;
-        if (pos.x >= it->start - Road::WIDTH && pos.x <= it->end + Road::WIDTH) {
-            return it->road;
-        }
+    if (auto id = FindRoadIdAt(pos)) {
+        return &roads_[*id];
     }
+    return nullptr;
+}
 
-    auto v_lower =
-        std::lower_bound(vertical_roads_.begin(), vertical_roads_.end(), pos.x - Road::WIDTH,
-                         [](const RoadSegment& seg, double x) { return seg.fixed_coord < x; });
-
-    for (auto it = v_lower; it != vertical_roads_.end(); ++it) {
-        if (it->fixed_coord > pos.x + Road::WIDTH) break;
-        if (pos.y >= it->start - Road::WIDTH && pos.y <= it->end + Road::WIDTH) {
-            return it->road;
+std::optional<RoadIndex::RoadId> Map::FindRoadIdAt(DogPos pos) const noexcept {
+    for (const RoadIndex::RoadId id : road_index_.Candidates(pos.x, pos.y)) {
+        if (road_index_.GetBounds(id).Contains(pos.x, pos.y)) {
+            return id;
         }
     }
-
-    return nullptr;
+    return std::nullopt;
 }
 
 const MoveResult Map::ProjectMove(DogPos cur_pos, DogVelocity velocity, double time_delta) const {
     DogPos target{cur_pos.x + velocity.vx * time_delta, cur_pos.y + velocity.vy * time_delta};
 
-    std::vector<const Road*> current_roads;
-    const double tolerance = Road::WIDTH;
-
-    for (const auto& road : roads_) {
-        if (road.IsHorizontal()) {
-            int road_y = road.GetStart().y;
-            int min_x = std::min(road.GetStart().x, road.GetEnd().x);
-            int max_x = std::max(road.GetStart().x, road.GetEnd().x);
-
-            if (std::abs(cur_pos.y - road_y) <= tolerance && cur_pos.x >= min_x - tolerance &&
-                cur_pos.x <= max_x + tolerance) {
-                current_roads.push_back(&road);
-            }
-        } else {
-            int road_x = road.GetStart().x;
-            int min_y = std::min(road.GetStart().y, road.GetEnd().y);
-            int max_y = std::max(road.GetStart().y, road.GetEnd().y);
-
-            if (std::abs(cur_pos.x - road_x) <= tolerance && cur_pos.y >= min_y - tolerance &&
-                cur_pos.y <= max_y + tolerance) {
-                current_roads.push_back(&road);
-            }
-        }
-    }
-
-    if (current_roads.empty()) {
-        return {cur_pos, true};
-    }
-
-    const Road* target_road = FindRoadAt(target);
-    if (target_road) {
-        return {target, false};
-    }
-
+    bool on_road = false;
     DogPos best_pos = cur_pos;
     double best_distance = 0.0;
 
-    for (const Road* road : current_roads) {
-        DogPos constrained = target;
-
-        if (road->IsHorizontal()) {
-            int road_y = road->GetStart().y;
-            int min_x = std::min(road->GetStart().x, road->GetEnd().x);
-            int max_x = std::max(road->GetStart().x, road->GetEnd().x);
-
-            constrained.x = std::clamp(target.x, min_x - Road::WIDTH, max_x + Road::WIDTH);
-            constrained.y = std::clamp(target.y, road_y - Road::WIDTH, road_y + Road::WIDTH);
-        } else {
-            int road_x = road->GetStart().x;
-            int min_y = std::min(road->GetStart().y, road->GetEnd().y);
-            int max_y = std::max(road->GetStart().y, road->GetEnd().y);
-
-            constrained.y = std::clamp(target.y, min_y - Road::WIDTH, max_y + Road::WIDTH);
-            constrained.x = std::clamp(target.x, road_x - Road::WIDTH, road_x + Road::WIDTH);
+    // Среди дорог, на которых стоит собака, выбираем ту, что позволяет уйти дальше всего
+    for (const RoadIndex::RoadId id : road_index_.Candidates(cur_pos.x, cur_pos.y)) {
+        const RoadBounds& bounds = road_index_.GetBounds(id);
+        if (!bounds.Contains(cur_pos.x, cur_pos.y)) {
+            continue;
         }
+        on_road = true;
+
+        DogPos constrained{std::clamp(target.x, bounds.min_x, bounds.max_x),
+                           std::clamp(target.y, bounds.min_y, bounds.max_y)};
 
         double dx = constrained.x - cur_pos.x;
         double dy = constrained.y - cur_pos.y;
@@ -104,6 +53,14 @@ const MoveResult Map::ProjectMove(DogPos cur_pos, DogVelocity velocity, double t
         }
     }
 
+    if (!on_road) {
+        return {cur_pos, true};
+    }
+
+    if (FindRoadAt(target)) {
+        return {target, false};
+    }
+
     bool stopped = (best_pos.x != target.x || best_pos.y != target.y);
     return {best_pos, stopped};
 }
@@ -123,29 +80,28 @@ void Map::AddOffice(Office office) {
     }
 }
 
+DogPos Map::RoadPoint(RoadSample sample) const noexcept {
+    const Point a = roads_[sample.road].GetStart();
+    const Point b = roads_[sample.road].GetEnd();
+    return {a.x + (b.x - a.x) * sample.offset, a.y + (b.y - a.y) * sample.offset};
+}
+
 void Map::BuildRoadIndex() {
+    std::vector<RoadBounds> bounds;
+    std::vector<double> lengths;
+    bounds.reserve(roads_.size());
+    lengths.reserve(roads_.size());
+
     for (const auto& road : roads_) {
-        RoadSegment segment{&road, 0, 0, 0};
-
-        if (road.IsHorizontal()) {
-            segment.fixed_coord = road.GetStart().y;
-            segment.start = std::min(road.GetStart().x, road.GetEnd().x);
-            segment.end = std::max(road.GetStart().x, road.GetEnd().x);
-            horizontal_roads_.push_back(segment);
-        } else {
-            segment.fixed_coord = road.GetStart().x;
-            segment.start = std::min(road.GetStart().y, road.GetEnd().y);
-            segment.end = std::max(road.GetStart().y, road.GetEnd().y);
-            vertical_roads_.push_back(segment);
-        }
+        const Point a = road.GetStart();
+        const Point b = road.GetEnd();
+        bounds.push_back({std::min(a.x, b.x) - Road::WIDTH, std::max(a.x, b.x) + Road::WIDTH,
+                          std::min(a.y, b.y) - Road::WIDTH, std::max(a.y, b.y) + Road::WIDTH});
+        lengths.push_back(std::abs(b.x - a.x) + std::abs(b.y - a.y));
     }
 
-    auto h_comparator = [](const RoadSegment& a, const RoadSegment& b) {
-        return a.fixed_coord < b.fixed_coord ||
-               (a.fixed_coord == b.fixed_coord && a.start < b.start);
-    };
-    std::sort(horizontal_roads_.begin(), horizontal_roads_.end(), h_comparator);
-    std::sort(vertical_roads_.begin(), vertical_roads_.end(), h_comparator);
+    road_index_.Build(std::move(bounds));
+    road_sampler_.Build(lengths);
 }
 
 void Game::AddMap(Map map) {
@@ -169,7 +125,13 @@ std::shared_ptr<GameSession> Game::GetOrCreateSession(const Map::Id& map_id) {
     if (auto it = sessions_by_map_.find(map_id); it != sessions_by_map_.end()) return it->second;
 
     auto session = std::make_shared<GameSession>(map);
-    sessions_by_map_.emplace(map_id, session);
+    sessions_.push_back(session);
+    try {
+        sessions_by_map_.emplace(map_id, session);
+    } catch (...) {
+        sessions_.pop_back();
+        throw;
+    }
     return session;
 }
 
@@ -1,10 +1,13 @@
 #pragma once
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "road_index.h"
+#include "road_sampler.h"
 #include "tagged.h"
 
 namespace model {
@@ -117,6 +120,8 @@ class Map {
     using Buildings = std::vector<Building>;
     using Offices = std::vector<Office>;
 
+    static constexpr RoadIndex::RoadId NO_ROAD = ~RoadIndex::RoadId{0};
+
     Map(Id id, std::string name) noexcept : id_(std::move(id)), name_(std::move(name)) {}
 
     const Id& GetId() const noexcept { return id_; }
@@ -133,14 +138,41 @@ class Map {
 
     const Road* FindRoadAt(DogPos pos) const;
 
+    std::optional<RoadIndex::RoadId> FindRoadIdAt(DogPos pos) const noexcept;
+
+    const RoadBounds& GetRoadBounds(RoadIndex::RoadId id) const noexcept {
+        return road_index_.GetBounds(id);
+    }
+
     const MoveResult ProjectMove(DogPos cur_pos, DogVelocity velocity, double time_delta) const;
 
+    // Случайная точка, равномерно распределённая по длине всех дорог карты
+    template <typename URBG>
+    DogPos GetRandomRoadPoint(URBG& gen) const {
+        if (road_sampler_.Empty()) {
+            throw std::logic_error("Map " + *id_ + " has no roads");
+        }
+        return RoadPoint(road_sampler_.Sample(gen));
+    }
+
+    // count таких точек за O(count) - для волн трофеев и собак
+    template <typename URBG>
+    std::vector<DogPos> GetRandomRoadPoints(URBG& gen, std::size_t count) const {
+        std::vector<DogPos> points;
+        points.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            points.push_back(GetRandomRoadPoint(gen));
+        }
+        return points;
+    }
+
     void AddRoad(const Road& road) { roads_.emplace_back(road); }
 
     void AddBuilding(const Building& building) { buildings_.emplace_back(building); }
 
     void AddOffice(Office office);
 
+    // Строит индекс дорог и таблицу выбора случайной точки. Вызывается после загрузки дорог.
     void BuildRoadIndex();
 
     void SetDogSpeed(double speed) { dog_speed_ = speed; }
@@ -148,11 +180,7 @@ class Map {
    private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
 
-    struct RoadSegment {
-        const Road* road;
-        int fixed_coord;
-        int start, end;
-    };
+    DogPos RoadPoint(RoadSample sample) const noexcept;
 
     Id id_;
     std::string name_;
@@ -164,8 +192,8 @@ class Map {
 
     std::optional<double> dog_speed_;
 
-    std::vector<RoadSegment> horizontal_roads_;
-    std::vector<RoadSegment> vertical_roads_;
+    RoadIndex road_index_;
+    RoadSampler road_sampler_;
 };
 
 class GameSession;
@@ -173,6 +201,7 @@ class GameSession;
 class Game {
    public:
     using Maps = std::vector<Map>;
+    using Sessions = std::vector<std::shared_ptr<GameSession>>;
 
     void AddMap(Map map);
 
@@ -197,6 +226,8 @@ class Game {
         return nullptr;
     }
 
+    const Sessions& GetSessions() const noexcept { return sessions_; }
+
    private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
@@ -204,6 +235,7 @@ class Game {
     std::vector<Map> maps_;
     MapIdToIndex map_id_to_index_;
     std::unordered_map<Map::Id, std::shared_ptr<GameSession>, MapIdHasher> sessions_by_map_;
+    Sessions sessions_;
 
     double default_dog_speed_ = 1.0;
 };
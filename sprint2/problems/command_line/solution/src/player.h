@@ -24,8 +24,8 @@ class Player {
    private:
     Id id_;
     std::weak_ptr<GameSession> session_;
-    Dog dog_;
-
+    // Объявлен до dog_: генератор нужен уже при создании собаки
     std::mt19937 gen_;
+    Dog dog_;
 };
 }  // namespace model
\ No newline at end of file
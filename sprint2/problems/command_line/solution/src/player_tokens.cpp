@@ -1,29 +1,86 @@
 #include "player_tokens.h"
 
 namespace app {
-Token PlayerTokens::Issue(model::Player::Id player_id) {
-    Token token = Generate_();
-    token_to_player_.emplace(*token, player_id);
-    return token;
+namespace {
+constexpr std::size_t kInitialCapacity = 64;
+
+// Выдаются только токены в нижнем регистре, поэтому заглавные цифры не принимаем
+int HexDigit(char c) noexcept {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
+    return -1;
 }
+}  // namespace
+
+Token PlayerTokens::Issue(model::Player* player) {
+    std::unique_lock lock{mutex_};
+
+    // Заполненность таблицы держим не выше 1/2, чтобы поиск почти всегда укладывался в одну пробу
+    if ((size_ + 1) * 2 > slots_.size()) {
+        Grow();
+    }
+
+    Key key;
+    std::size_t index;
+    do {
+        key = {generator1_(), generator2_()};
+        index = Probe(key);
+    } while (slots_[index].player);
 
-std::optional<model::Player::Id> PlayerTokens::FindPlayerId(std::string_view token) const {
-    auto it = token_to_player_.find(std::string(token));
-    if (it == token_to_player_.end()) return std::nullopt;
-    return it->second;
+    slots_[index] = {key, player};
+    ++size_;
+    return Token(ToHex16_(key.hi) + ToHex16_(key.lo));
 }
-Token PlayerTokens::Generate_() {
-    const uint64_t a = generator1_();
-    const uint64_t b = generator2_();
-    return Token(ToHex16_(a) + ToHex16_(b));
+
+model::Player* PlayerTokens::FindPlayer(std::string_view token) const noexcept {
+    auto key = ParseHex(token);
+    if (!key) {
+        return nullptr;
+    }
+
+    std::shared_lock lock{mutex_};
+    if (slots_.empty()) {
+        return nullptr;
+    }
+    return slots_[Probe(*key)].player;
 }
-static std::string ToHex16_(uint64_t x) {
-    static constexpr char kHex[] = "0123456789abcdef";
-    std::string s(16, '0');
-    for (int i = 15; i >= 0; --i) {
-        s[i] = kHex[x & 0xF];
-        x >>= 4;
+
+std::optional<PlayerTokens::Key> PlayerTokens::ParseHex(std::string_view token) noexcept {
+    if (token.size() != TOKEN_LENGTH) {
+        return std::nullopt;
     }
-    return s;
+
+    Key key;
+    for (std::size_t i = 0; i < TOKEN_LENGTH; ++i) {
+        const int digit = HexDigit(token[i]);
+        if (digit < 0) {
+            return std::nullopt;
+        }
+        uint64_t& half = i < TOKEN_LENGTH / 2 ? key.hi : key.lo;
+        half = (half << 4) | static_cast<uint64_t>(digit);
+    }
+    return key;
+}
+
+// Индекс слота с ключом key либо первого свободного слота на его пути
+std::size_t PlayerTokens::Probe(const Key& key) const noexcept {
+    const std::size_t mask = slots_.size() - 1;
+    // Токены случайны, но всё равно перемешиваем биты, чтобы не зависеть от генератора
+    std::size_t index = static_cast<std::size_t>((key.hi ^ key.lo) * 0x9E3779B97F4A7C15ull) & mask;
+    while (slots_[index].player && slots_[index].key != key) {
+        index = (index + 1) & mask;
+    }
+    return index;
 }
-}  // namespace app
\ No newline at end of file
+
+void PlayerTokens::Grow() {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(old.empty() ? kInitialCapacity : old.size() * 2, Slot{});
+    for (const Slot& slot : old) {
+        if (slot.player) {
+            slots_[Probe(slot.key)] = slot;
+        }
+    }
+}
+
+}  // namespace app
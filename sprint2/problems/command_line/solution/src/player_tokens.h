@@ -1,7 +1,11 @@
 #pragma once
+#include <cstdint>
+#include <mutex>
 #include <optional>
 #include <random>
-#include <unordered_map>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
 
 #include "tagged.h"
 #include "player.h"
@@ -14,14 +18,35 @@ using Token = util::Tagged<std::string, detail::TokenTag>;
 
 namespace app {
 
+// Таблица токенов с открытой адресацией. Токен хранится как 128-битный ключ,
+// поиск идёт прямо по hex-строке из заголовка Authorization без выделения памяти.
+// FindPlayer можно вызывать из любых потоков одновременно с Issue.
 class PlayerTokens {
    public:
-    Token Issue(model::Player::Id player_id);
+    static constexpr std::size_t TOKEN_LENGTH = 32;
 
-    std::optional<model::Player::Id> FindPlayerId(std::string_view token) const;
+    Token Issue(model::Player* player);
+
+    // nullptr, если токен неизвестен или не является 32-символьной hex-строкой
+    model::Player* FindPlayer(std::string_view token) const noexcept;
 
    private:
-    Token Generate_();
+    struct Key {
+        uint64_t hi = 0;
+        uint64_t lo = 0;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct Slot {
+        Key key;
+        model::Player* player = nullptr;  // nullptr - слот свободен
+    };
+
+    static std::optional<Key> ParseHex(std::string_view token) noexcept;
+
+    std::size_t Probe(const Key& key) const noexcept;
+    void Grow();
 
     static std::string ToHex16_(uint64_t x) {
         static constexpr char kHex[] = "0123456789abcdef";
@@ -34,7 +59,9 @@ class PlayerTokens {
     }
 
    private:
-    std::unordered_map<std::string, model::Player::Id> token_to_player_;
+    mutable std::shared_mutex mutex_;
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
 
     std::random_device random_device_;
     std::mt19937_64 generator1_{[this] {
@@ -47,4 +74,4 @@ class PlayerTokens {
     }()};
 };
 
-}  // namespace app
\ No newline at end of file
+}  // namespace app
@@ -14,6 +14,7 @@ class Players {
     model::Player* Find(model::Player::Id id) noexcept;
     const std::vector<model::Player::Id>* ListInSession(
         const std::shared_ptr<model::GameSession>& session) const;
+    std::size_t Count() const noexcept { return players_.size(); }
 
    private:
     model::Player::Id next_id_ = 0;
@@ -8,10 +8,13 @@
 #include <filesystem>
 #include <string_view>
 #include <utility>
+#include <variant>
 
 #include "api_handler.h"
 #include "application.h"
 #include "file_handler.h"
+#include "metrics.h"
+#include "tracing.h"
 
 namespace http_handler {
 
@@ -21,11 +24,10 @@ namespace net = boost::asio;
 class RequestHandler {
    public:
     explicit RequestHandler(net::strand<net::io_context::executor_type>&& strand, app::Application &application,
-                            const fs::path &root)
+                            const StaticCache &static_cache)
         : application_{application},
-          root_{root},
           api_handler_{application},
-          file_handler_{root_},
+          file_handler_{static_cache},
           app_strand_(std::move(strand)) {}
 
     RequestHandler(const RequestHandler &) = delete;
@@ -35,21 +37,65 @@ class RequestHandler {
     void operator()(http::request<Body, http::basic_fields<Allocator>> &&req, Send &&send) {
         const std::string_view target = req.target();
 
+        if (target == Endpoint::METRICS) {
+            // Сбор метрик только читает счётчики и не нуждается в strand приложения
+            send(MakeMetricsResponse(req.method(), req.version(), req.keep_alive()));
+            return;
+        }
+
         if (url::IsApi(target)) {
+            if (ApiHandler::IsConcurrentRead(req.method(), target)) {
+                std::visit([&send](auto &&response) { send(std::move(response)); },
+                           api_handler_.Handle(std::move(req)));
+                return;
+            }
+
+            // Изменяющие запросы упорядочиваются через strand приложения.
+            // Память запроса принадлежит соединению, которое удерживает send, поэтому
+            // req объявлен после send и уничтожается раньше него.
             using Req = http::request<Body, http::basic_fields<Allocator>>;
             using SendT = std::decay_t<Send>;
-            net::dispatch(app_strand_, [this, req = Req(std::move(req)),
-                                        send = SendT(std::forward<Send>(send))]() mutable {
-                send(api_handler_.Handle(std::move(req)));
+            struct Task {
+                SendT send;
+                Req req;
+            };
+            app_metrics::OnStrandEnqueued();
+            const auto enqueued = app_tracing::Now();
+            net::dispatch(app_strand_, [this, enqueued,
+                                        task = Task{SendT(std::forward<Send>(send)),
+                                                    Req(std::move(req))}]() mutable {
+                app_metrics::OnStrandDequeued();
+                if (enqueued != app_tracing::Clock::time_point{}) {
+                    app_tracing::Record("app.strand_wait", enqueued, app_tracing::Clock::now(), 0,
+                                        app_tracing::NextAsyncId());
+                }
+                std::visit([&task](auto &&response) { task.send(std::move(response)); },
+                           api_handler_.Handle(std::move(task.req)));
             });
         } else {
+            app_tracing::Span span{"static.handle"};
             file_handler_.Handle(std::move(req), std::forward<Send>(send));
         }
     }
 
    private:
+    static StringResponse MakeMetricsResponse(http::verb method, unsigned version,
+                                              bool keep_alive) {
+        if (method != http::verb::get && method != http::verb::head) {
+            auto response = MakeJsonError(http::status::method_not_allowed, "invalidMethod"sv,
+                                          "Invalid method"sv, version, keep_alive);
+            response.set(http::field::allow, "GET, HEAD"sv);
+            return response;
+        }
+        auto response = MakeStringResponse(http::status::ok, app_metrics::RenderPrometheus(),
+                                           version, keep_alive, ContentType::PROMETHEUS);
+        if (method == http::verb::head) {
+            response.body().clear();
+        }
+        return response;
+    }
+
     app::Application &application_;
-    const fs::path &root_;
     net::strand<net::io_context::executor_type> app_strand_;
 
     ApiHandler api_handler_;
@@ -0,0 +1,83 @@
+#include "road_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace model {
+namespace {
+// Примерное число ячеек сетки на одну дорогу
+constexpr double kCellsPerRoad = 4.0;
+constexpr double kMinCellSize = 1.0;
+}  // namespace
+
+void RoadIndex::Build(std::vector<RoadBounds> bounds) {
+    bounds_ = std::move(bounds);
+    cell_offsets_.clear();
+    cell_roads_.clear();
+    columns_ = rows_ = 0;
+
+    if (bounds_.empty()) {
+        return;
+    }
+
+    origin_x_ = origin_y_ = std::numeric_limits<double>::max();
+    max_x_ = max_y_ = std::numeric_limits<double>::lowest();
+    for (const auto& b : bounds_) {
+        origin_x_ = std::min(origin_x_, b.min_x);
+        origin_y_ = std::min(origin_y_, b.min_y);
+        max_x_ = std::max(max_x_, b.max_x);
+        max_y_ = std::max(max_y_, b.max_y);
+    }
+
+    const double area = (max_x_ - origin_x_) * (max_y_ - origin_y_);
+    const double target_cells = kCellsPerRoad * static_cast<double>(bounds_.size());
+    cell_size_ = std::max(kMinCellSize, std::sqrt(area / target_cells));
+    columns_ = static_cast<std::size_t>((max_x_ - origin_x_) / cell_size_) + 1;
+    rows_ = static_cast<std::size_t>((max_y_ - origin_y_) / cell_size_) + 1;
+
+    // Два прохода: сначала считаем число дорог в каждой ячейке, затем раскладываем индексы
+    cell_offsets_.assign(columns_ * rows_ + 1, 0);
+    auto for_each_cell = [this](const RoadBounds& b, auto&& fn) {
+        const std::size_t col0 = CellColumn(b.min_x), col1 = CellColumn(b.max_x);
+        const std::size_t row0 = CellRow(b.min_y), row1 = CellRow(b.max_y);
+        for (std::size_t row = row0; row <= row1; ++row) {
+            for (std::size_t col = col0; col <= col1; ++col) {
+                fn(row * columns_ + col);
+            }
+        }
+    };
+
+    for (const auto& b : bounds_) {
+        for_each_cell(b, [this](std::size_t cell) { ++cell_offsets_[cell + 1]; });
+    }
+    for (std::size_t i = 1; i < cell_offsets_.size(); ++i) {
+        cell_offsets_[i] += cell_offsets_[i - 1];
+    }
+
+    cell_roads_.resize(cell_offsets_.back());
+    std::vector<std::uint32_t> fill(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (RoadId id = 0; id < bounds_.size(); ++id) {
+        for_each_cell(bounds_[id], [&](std::size_t cell) { cell_roads_[fill[cell]++] = id; });
+    }
+}
+
+std::span<const RoadIndex::RoadId> RoadIndex::Candidates(double x, double y) const noexcept {
+    if (columns_ == 0 || x < origin_x_ || x > max_x_ || y < origin_y_ || y > max_y_) {
+        return {};
+    }
+    const std::size_t cell = CellRow(y) * columns_ + CellColumn(x);
+    return {cell_roads_.data() + cell_offsets_[cell], cell_roads_.data() + cell_offsets_[cell + 1]};
+}
+
+std::size_t RoadIndex::CellColumn(double x) const noexcept {
+    const auto col = static_cast<std::size_t>(std::max(0.0, (x - origin_x_) / cell_size_));
+    return std::min(col, columns_ - 1);
+}
+
+std::size_t RoadIndex::CellRow(double y) const noexcept {
+    const auto row = static_cast<std::size_t>(std::max(0.0, (y - origin_y_) / cell_size_));
+    return std::min(row, rows_ - 1);
+}
+
+}  // namespace model
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace model {
+
+// Прямоугольник, занимаемый дорогой с учётом её ширины
+struct RoadBounds {
+    double min_x, max_x;
+    double min_y, max_y;
+
+    bool Contains(double x, double y) const noexcept {
+        return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+    }
+};
+
+// Равномерная сетка поверх дорог карты. Каждая ячейка хранит индексы дорог,
+// пересекающих её, поэтому поиск дорог в точке не зависит от их общего числа.
+class RoadIndex {
+   public:
+    using RoadId = std::uint32_t;
+
+    void Build(std::vector<RoadBounds> bounds);
+
+    // Дороги, чьи прямоугольники пересекают ячейку с точкой (x, y).
+    // Точку всё ещё нужно проверить через GetBounds(id).Contains(x, y).
+    std::span<const RoadId> Candidates(double x, double y) const noexcept;
+
+    const RoadBounds& GetBounds(RoadId id) const noexcept { return bounds_[id]; }
+
+    std::size_t RoadCount() const noexcept { return bounds_.size(); }
+
+   private:
+    std::size_t CellColumn(double x) const noexcept;
+    std::size_t CellRow(double y) const noexcept;
+
+    std::vector<RoadBounds> bounds_;
+
+    double origin_x_ = 0.0;
+    double origin_y_ = 0.0;
+    double max_x_ = 0.0;
+    double max_y_ = 0.0;
+    double cell_size_ = 1.0;
+    std::size_t columns_ = 0;
+    std::size_t rows_ = 0;
+
+    // ячейка i содержит cell_roads_[cell_offsets_[i] .. cell_offsets_[i + 1])
+    std::vector<std::uint32_t> cell_offsets_;
+    std::vector<RoadId> cell_roads_;
+};
+
+}  // namespace model
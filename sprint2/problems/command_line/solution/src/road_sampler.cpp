@@ -0,0 +1,48 @@
+#include "road_sampler.h"
+
+#include <numeric>
+
+namespace model {
+
+void RoadSampler::Build(const std::vector<double>& weights) {
+    const std::size_t n = weights.size();
+    prob_.assign(n, 1.0);
+    alias_.resize(n);
+    std::iota(alias_.begin(), alias_.end(), std::uint32_t{0});
+
+    const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    if (n == 0 || total <= 0.0) {
+        return;
+    }
+
+    // Масштабируем так, чтобы средний вес был равен 1, и делим столбцы на недобравшие
+    // и переполненные. Каждый недобравший столбец добирается из одного переполненного.
+    std::vector<double> scaled(n);
+    std::vector<std::uint32_t> small, large;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * static_cast<double>(n) / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const std::uint32_t s = small.back();
+        const std::uint32_t l = large.back();
+        small.pop_back();
+        prob_[s] = scaled[s];
+        alias_[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Остатки отличаются от 1 только ошибкой округления
+    for (const std::uint32_t i : small) {
+        prob_[i] = 1.0;
+    }
+    for (const std::uint32_t i : large) {
+        prob_[i] = 1.0;
+    }
+}
+
+}  // namespace model
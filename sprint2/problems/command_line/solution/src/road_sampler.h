@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace model {
+
+// Случайная точка на дороге: номер дороги и доля её длины от начала, в [0, 1)
+struct RoadSample {
+    std::uint32_t road;
+    double offset;
+};
+
+// Таблица псевдонимов (метод Уолкера-Воуза) для выбора дороги с вероятностью,
+// пропорциональной её длине. Строится за O(n) при загрузке карты, каждая выборка - O(1),
+// поэтому точки распределены равномерно по всей дорожной сети.
+class RoadSampler {
+   public:
+    // weights[i] >= 0 - длина дороги i. Если все веса нулевые, дороги равновероятны.
+    void Build(const std::vector<double>& weights);
+
+    bool Empty() const noexcept { return prob_.empty(); }
+
+    template <typename URBG>
+    RoadSample Sample(URBG& gen) const {
+        std::uniform_real_distribution<double> dist{0.0, 1.0};
+        const double u = dist(gen) * static_cast<double>(prob_.size());
+        // u < size, но округление при умножении может дать ровно size
+        std::uint32_t column = static_cast<std::uint32_t>(u);
+        if (column >= prob_.size()) {
+            column = static_cast<std::uint32_t>(prob_.size() - 1);
+        }
+        const std::uint32_t road = u - column < prob_[column] ? column : alias_[column];
+        return {road, dist(gen)};
+    }
+
+   private:
+    std::vector<double> prob_;
+    std::vector<std::uint32_t> alias_;
+};
+
+}  // namespace model
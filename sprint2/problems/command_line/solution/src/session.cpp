@@ -1,8 +1,81 @@
 #include "session.h"
 
+#include <algorithm>
+#include <cassert>
+
 #include "model.h"
 
 namespace model {
-GameSession::GameSession(const Map* map) : map_(map) {}
+namespace {
+constexpr std::size_t kMinRosterCapacity = 16;
+}  // namespace
+
+void SessionRoster::Append(int player_id, std::string name) {
+    if (!storage_ || storage_->used != size_ || size_ == storage_->entries.size()) {
+        // Новое хранилище вдвое больше, поэтому копирование записей амортизируется
+        auto storage = std::make_shared<Storage>();
+        storage->entries.resize(std::max(kMinRosterCapacity, 2 * size_));
+        for (std::size_t i = 0; i < size_; ++i) {
+            storage->entries[i] = storage_->entries[i];
+        }
+        storage->used = size_;
+        storage_ = std::move(storage);
+    }
+    storage_->entries[size_] = {player_id, std::move(name)};
+    storage_->used = ++size_;
+}
+
+GameSession::GameSession(const Map* map)
+    : map_(map), dogs_(*map), state_(std::make_shared<SessionState>()) {}
+
 const Map& GameSession::GetMap() const noexcept { return *map_; }
-}  // namespace model
\ No newline at end of file
+
+void GameSession::AddToRoster(int player_id, std::string name) {
+    roster_.Append(player_id, std::move(name));
+    changed_ = true;
+}
+
+std::shared_ptr<SessionState> GameSession::CaptureState() {
+    assert(roster_.Size() == dogs_.Size());
+
+    // Простаивающая сессия сохраняет прежний снимок, и клиенты получают 304
+    if (!changed_) {
+        return nullptr;
+    }
+    changed_ = false;
+    const auto previous = GetState();
+    if (previous->roster == roster_ && SameDogs(previous->dogs)) {
+        return nullptr;
+    }
+
+    auto state = std::make_shared<SessionState>();
+    state->tick = tick_;
+    state->roster = roster_;
+    state->dogs.reserve(dogs_.Size());
+    for (DogStore::Index i = 0; i < dogs_.Size(); ++i) {
+        state->dogs.push_back({dogs_.GetPosition(i), dogs_.GetVelocity(i), dogs_.GetDirection(i)});
+    }
+
+    state->revision = ++revision_;
+    state->roster_revision =
+        previous->roster == state->roster ? previous->roster_revision : state->revision;
+    return state;
+}
+
+bool GameSession::SameDogs(const std::vector<DogState>& dogs) const noexcept {
+    if (dogs.size() != dogs_.Size()) {
+        return false;
+    }
+    for (DogStore::Index i = 0; i < dogs.size(); ++i) {
+        if (!(dogs[i] ==
+              DogState{dogs_.GetPosition(i), dogs_.GetVelocity(i), dogs_.GetDirection(i)})) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GameSession::PublishState(std::shared_ptr<const SessionState> state) {
+    std::atomic_store_explicit(&state_, std::move(state), std::memory_order_release);
+}
+}  // namespace model
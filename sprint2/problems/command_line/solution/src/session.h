@@ -1,15 +1,136 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dog_store.h"
+
 namespace model {
 
 class Map;
 
+struct DogState {
+    DogPos position;
+    DogVelocity velocity;
+    DogDirection direction;
+
+    bool operator==(const DogState& other) const noexcept {
+        return position.x == other.position.x && position.y == other.position.y &&
+               velocity.vx == other.velocity.vx && velocity.vy == other.velocity.vy &&
+               direction == other.direction;
+    }
+};
+
+// Игроки сессии в порядке входа; i-й игрок управляет i-й собакой DogStore.
+// Копии разделяют хранилище, в которое записи только дописываются, поэтому копирование
+// стоит O(1), а копия видит ровно те записи, что были на момент копирования. Снимки
+// можно читать из любых потоков, пока владелец сессии дописывает новых игроков.
+class SessionRoster {
+   public:
+    struct Entry {
+        int player_id = 0;
+        std::string name;
+    };
+
+    std::size_t Size() const noexcept { return size_; }
+
+    const Entry& operator[](std::size_t index) const noexcept {
+        return storage_->entries[index];
+    }
+
+    // Амортизированно O(1). Вызывается только из потока, который владеет списком.
+    void Append(int player_id, std::string name);
+
+    // Копии одного и того же состояния списка
+    bool operator==(const SessionRoster& other) const noexcept {
+        return storage_ == other.storage_ && size_ == other.size_;
+    }
+
+   private:
+    struct Storage {
+        // Размер не меняется после создания: записи за пределами size_ копий
+        // заполняются на месте, а читатели к ним не обращаются
+        std::vector<Entry> entries;
+        // Число заполненных записей; если копия отстаёт, дописывать в хранилище ей нельзя
+        std::size_t used = 0;
+    };
+
+    std::shared_ptr<Storage> storage_;
+    std::size_t size_ = 0;
+};
+
+// Сериализованное тело ответа и его ETag
+struct EncodedBody {
+    std::shared_ptr<const std::string> data;
+    std::string etag;
+};
+
+// Неизменяемый снимок сессии для читателей из любых потоков
+struct SessionState {
+    // номер тика, на котором снят снимок
+    std::uint64_t tick = 0;
+    // растёт при каждом изменении содержимого снимка
+    std::uint64_t revision = 0;
+    // ревизия, на которой последний раз изменился список игроков
+    std::uint64_t roster_revision = 0;
+    SessionRoster roster;
+    std::vector<DogState> dogs;
+
+    // Сериализованные ответы, общие для всех читателей снимка
+    EncodedBody state_json;
+    EncodedBody state_binary;
+    EncodedBody players_json;
+    EncodedBody players_binary;
+    // Разностный кадр относительно предыдущей ревизии; строится, только если есть подписчики
+    std::shared_ptr<const std::string> delta_body;
+};
+
 class GameSession {
    public:
     explicit GameSession(const Map* map);
     const Map& GetMap() const noexcept;
 
+    DogStore& GetDogs() noexcept { return dogs_; }
+    const DogStore& GetDogs() const noexcept { return dogs_; }
+
+    // Изменяющие методы вызываются только из потока, который владеет сессией
+    void Tick(double dt) {
+        if (dogs_.Integrate(dt)) {
+            changed_ = true;
+        }
+        ++tick_;
+    }
+
+    void AddToRoster(int player_id, std::string name);
+
+    // Сообщает, что собаки изменились в обход Tick, например по команде игрока
+    void MarkChanged() noexcept { changed_ = true; }
+
+    // Снимает текущее состояние сессии. Возвращает nullptr, если с последней
+    // публикации ничего не изменилось, и публиковать новый снимок не нужно.
+    // Такая проверка не выделяет память.
+    std::shared_ptr<SessionState> CaptureState();
+    void PublishState(std::shared_ptr<const SessionState> state);
+
+    // Последний опубликованный снимок. Безопасно вызывать из любого потока.
+    std::shared_ptr<const SessionState> GetState() const noexcept {
+        return std::atomic_load_explicit(&state_, std::memory_order_acquire);
+    }
+
    private:
+    bool SameDogs(const std::vector<DogState>& dogs) const noexcept;
+
     const Map* map_;
+    DogStore dogs_;
+
+    SessionRoster roster_;
+    std::uint64_t tick_ = 0;
+    std::uint64_t revision_ = 0;
+    // с последнего снимка могли измениться собаки или список игроков
+    bool changed_ = false;
+    std::shared_ptr<const SessionState> state_;
 };
-}  // namespace model
\ No newline at end of file
+}  // namespace model
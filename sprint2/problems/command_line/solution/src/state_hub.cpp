@@ -0,0 +1,48 @@
+#include "state_hub.h"
+
+namespace app {
+
+void StateHub::Subscribe(const model::GameSession& session,
+                         std::weak_ptr<StateSubscriber> subscriber) {
+    std::lock_guard lock{mutex_};
+    subscribers_[&session].push_back(std::move(subscriber));
+}
+
+bool StateHub::HasSubscribers(const model::GameSession& session) const {
+    std::lock_guard lock{mutex_};
+    auto it = subscribers_.find(&session);
+    return it != subscribers_.end() && !it->second.empty();
+}
+
+void StateHub::Publish(const model::GameSession& session,
+                       const std::shared_ptr<const model::SessionState>& state) {
+    std::vector<std::shared_ptr<StateSubscriber>> alive;
+    {
+        std::lock_guard lock{mutex_};
+        auto it = subscribers_.find(&session);
+        if (it == subscribers_.end()) {
+            return;
+        }
+
+        Subscribers& subscribers = it->second;
+        alive.reserve(subscribers.size());
+        std::erase_if(subscribers, [&alive](const std::weak_ptr<StateSubscriber>& weak) {
+            auto subscriber = weak.lock();
+            if (!subscriber) {
+                return true;
+            }
+            alive.push_back(std::move(subscriber));
+            return false;
+        });
+        if (subscribers.empty()) {
+            subscribers_.erase(it);
+        }
+    }
+
+    // Подписчики уведомляются вне блокировки, чтобы не задерживать другие сессии
+    for (const auto& subscriber : alive) {
+        subscriber->OnStatePublished(state);
+    }
+}
+
+}  // namespace app
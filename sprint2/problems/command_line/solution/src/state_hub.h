@@ -0,0 +1,37 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "session.h"
+
+namespace app {
+
+// Получатель опубликованных снимков сессии. Вызывается из потоков тика,
+// поэтому реализация должна лишь передать снимок в свой поток.
+class StateSubscriber {
+   public:
+    virtual void OnStatePublished(std::shared_ptr<const model::SessionState> state) = 0;
+
+   protected:
+    ~StateSubscriber() = default;
+};
+
+// Рассылает опубликованные снимки подписчикам игровых сессий.
+// Подписчики хранятся по weak_ptr и удаляются при первой рассылке после их уничтожения.
+class StateHub {
+   public:
+    void Subscribe(const model::GameSession& session, std::weak_ptr<StateSubscriber> subscriber);
+    bool HasSubscribers(const model::GameSession& session) const;
+    void Publish(const model::GameSession& session,
+                 const std::shared_ptr<const model::SessionState>& state);
+
+   private:
+    using Subscribers = std::vector<std::weak_ptr<StateSubscriber>>;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<const model::GameSession*, Subscribers> subscribers_;
+};
+
+}  // namespace app
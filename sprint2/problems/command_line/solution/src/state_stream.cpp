@@ -0,0 +1,179 @@
+#include "state_stream.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/beast/websocket.hpp>
+#include <cstdint>
+#include <memory>
+
+#include "auth.h"
+#include "http_response.h"
+#include "json_serializer.h"
+#include "metrics.h"
+#include "url_utils.h"
+
+namespace http_handler {
+namespace net = boost::asio;
+namespace websocket = beast::websocket;
+
+namespace {
+
+class StateStreamSession : public app::StateSubscriber,
+                           public std::enable_shared_from_this<StateStreamSession> {
+   public:
+    StateStreamSession(http_server::Stream&& stream, app::Application& application,
+                       const model::Player& player)
+        : ws_(std::move(stream)), application_(application), player_(player) {
+        app_metrics::OnConnectionOpened(app_metrics::Connection::WebSocket);
+    }
+
+    ~StateStreamSession() { app_metrics::OnConnectionClosed(app_metrics::Connection::WebSocket); }
+
+    void Run(StringRequest&& request) {
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        ws_.text(true);
+        ws_.async_accept(request,
+                         beast::bind_front_handler(&StateStreamSession::OnAccept, shared_from_this()));
+    }
+
+    void OnStatePublished(std::shared_ptr<const model::SessionState> state) override {
+        // Вызывается из потоков тика: всё состояние соединения меняется только в его strand
+        net::post(ws_.get_executor(), [self = shared_from_this(), state = std::move(state)] {
+            self->Enqueue(state);
+        });
+    }
+
+   private:
+    void OnAccept(beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+        if (auto state = application_.SubscribeToState(player_, weak_from_this())) {
+            Enqueue(std::move(state));
+        }
+        Read();
+    }
+
+    // Сообщения клиента не несут команд, но читать их нужно ради ping и close
+    void Read() {
+        ws_.async_read(read_buffer_,
+                       beast::bind_front_handler(&StateStreamSession::OnRead, shared_from_this()));
+    }
+
+    void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
+        if (ec) {
+            closed_ = true;
+            return;
+        }
+        read_buffer_.consume(read_buffer_.size());
+        Read();
+    }
+
+    void Enqueue(std::shared_ptr<const model::SessionState> state) {
+        if (closed_) {
+            return;
+        }
+        // Медленный клиент получает только последний снимок: промежуточные выбрасываются
+        if (!pending_ || state->revision > pending_->revision) {
+            pending_ = std::move(state);
+        }
+        if (!writing_) {
+            WriteNext();
+        }
+    }
+
+    void WriteNext() {
+        auto state = std::move(pending_);
+        if (!state || state->revision <= sent_revision_) {
+            return;
+        }
+
+        // Разностный кадр годится, только если клиент видел предыдущую ревизию
+        if (sent_revision_ != 0 && state->revision == sent_revision_ + 1 && state->delta_body) {
+            frame_ = state->delta_body;
+        } else {
+            frame_ = std::make_shared<const std::string>(
+                json_serialization::SerializeStateFrame(*state, nullptr));
+        }
+        sent_revision_ = state->revision;
+
+        writing_ = true;
+        ws_.async_write(net::buffer(*frame_),
+                        beast::bind_front_handler(&StateStreamSession::OnWrite, shared_from_this()));
+    }
+
+    void OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+        writing_ = false;
+        frame_.reset();
+        if (ec) {
+            closed_ = true;
+            return;
+        }
+        WriteNext();
+    }
+
+    websocket::stream<http_server::Stream> ws_;
+    app::Application& application_;
+    const model::Player& player_;
+
+    beast::flat_buffer read_buffer_;
+    std::shared_ptr<const model::SessionState> pending_;
+    std::shared_ptr<const std::string> frame_;
+    std::uint64_t sent_revision_ = 0;
+    bool writing_ = false;
+    bool closed_ = false;
+};
+
+// Отвечает на отклонённый Upgrade обычным HTTP-ответом и закрывает соединение
+void Reject(http_server::Stream&& stream, StringResponse&& response) {
+    struct Rejection {
+        http_server::Stream stream;
+        StringResponse response;
+    };
+    response.keep_alive(false);
+    auto rejection = std::make_shared<Rejection>(Rejection{std::move(stream), std::move(response)});
+    rejection->stream.expires_after(std::chrono::seconds{30});
+    http::async_write(rejection->stream, rejection->response,
+                      [rejection](beast::error_code, std::size_t) {
+                          beast::error_code ec;
+                          rejection->stream.socket().shutdown(net::ip::tcp::socket::shutdown_send,
+                                                              ec);
+                      });
+}
+
+}  // namespace
+
+void StateStreamHandler::operator()(http_server::Stream&& stream, StringRequest&& request,
+                                    [[maybe_unused]] const std::string& client_ip) const {
+    const unsigned version = request.version();
+    const auto [path, query] = url::SplitQuery(request.target());
+    if (path != Endpoint::STATE_STREAM) {
+        return Reject(std::move(stream), MakeJsonError(http::status::bad_request, "badRequest"sv,
+                                                       "Bad request"sv, version, false));
+    }
+
+    auto token = ExtractBearerToken(request);
+    if (!token) {
+        token = url::FindQueryParam(query, "token"sv);
+    }
+    if (!token) {
+        return Reject(std::move(stream),
+                      MakeJsonError(http::status::unauthorized, "invalidToken"sv,
+                                    "Authorization header is missing"sv, version, false));
+    }
+    if (!IsValidTokenFormat(*token)) {
+        return Reject(std::move(stream), MakeJsonError(http::status::unauthorized, "invalidToken"sv,
+                                                       "Invalid token"sv, version, false));
+    }
+
+    const model::Player* player = application_->Authorize(*token);
+    if (!player) {
+        return Reject(std::move(stream),
+                      MakeJsonError(http::status::unauthorized, "unknownToken"sv,
+                                    "Player token has not been found"sv, version, false));
+    }
+
+    std::make_shared<StateStreamSession>(std::move(stream), *application_, *player)
+        ->Run(std::move(request));
+}
+
+}  // namespace http_handler
@@ -0,0 +1,28 @@
+#pragma once
+#include <boost/beast/http.hpp>
+#include <string>
+
+#include "application.h"
+#include "http_server.h"
+#include "http_types.h"
+
+namespace http_handler {
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+// Обслуживает запросы WebSocket Upgrade на Endpoint::STATE_STREAM.
+// Клиент авторизуется заголовком Authorization или параметром ?token= (браузерам
+// недоступны заголовки WebSocket) и получает кадры своей сессии: сначала полный,
+// затем на каждом тике - только собак, чьё состояние изменилось.
+class StateStreamHandler {
+   public:
+    explicit StateStreamHandler(app::Application& application) : application_{&application} {}
+
+    void operator()(http_server::Stream&& stream, StringRequest&& request,
+                    const std::string& client_ip) const;
+
+   private:
+    app::Application* application_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,287 @@
+#include "static_cache.h"
+
+#include <brotli/encode.h>
+#include <sys/inotify.h>
+#include <zlib.h>
+
+#include <array>
+#include <boost/asio/post.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/json.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/log/utility/manipulators/add_value.hpp>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "http_response.h"
+#include "logging.h"
+
+namespace http_handler {
+namespace net = boost::asio;
+namespace sys = boost::system;
+
+namespace {
+
+// Качество 11 сжимает three.js лишь на 10% лучше, но в 25 раз дольше, а сжатие идёт при старте
+constexpr int kBrotliQuality = 9;
+
+// Сжатый вариант хранится, только если он хотя бы на 10% меньше исходного файла
+bool WorthKeeping(const std::string& compressed, const std::string& original) {
+    return compressed.size() * 10 < original.size() * 9;
+}
+
+std::string Gzip(const std::string& data) {
+    z_stream stream{};
+    // 15 + 16: окно 32 КБ и заголовок gzip вместо zlib
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) !=
+        Z_OK) {
+        throw std::runtime_error("Failed to initialize gzip"s);
+    }
+
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    const int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error("Failed to gzip file"s);
+    }
+    return out;
+}
+
+std::string Brotli(const std::string& data, std::string_view content_type) {
+    const BrotliEncoderMode mode =
+        content_type.starts_with("text/"sv) || content_type == ContentType::JSON ||
+                content_type == ContentType::XML || content_type == ContentType::SVG
+            ? BROTLI_MODE_TEXT
+            : BROTLI_MODE_GENERIC;
+
+    std::size_t size = BrotliEncoderMaxCompressedSize(data.size());
+    std::string out(size, '\0');
+    if (!BrotliEncoderCompress(kBrotliQuality, BROTLI_DEFAULT_WINDOW, mode, data.size(),
+                               reinterpret_cast<const uint8_t*>(data.data()), &size,
+                               reinterpret_cast<uint8_t*>(out.data()))) {
+        throw std::runtime_error("Failed to compress file with brotli"s);
+    }
+    out.resize(size);
+    return out;
+}
+
+// ETag сжатого варианта отличается от исходного суффиксом: "0123abcd" -> "0123abcd-br"
+std::string VariantETag(std::string_view etag, std::string_view suffix) {
+    std::string result(etag.substr(0, etag.size() - 1));
+    result += suffix;
+    result += '"';
+    return result;
+}
+
+std::string HttpDate(fs::file_time_type time) {
+    const auto system_time = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        std::chrono::file_clock::to_sys(time));
+    const std::time_t t = std::chrono::system_clock::to_time_t(system_time);
+
+    std::tm tm{};
+    gmtime_r(&t, &tm);
+    char buffer[32];
+    const std::size_t size = std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return std::string(buffer, size);
+}
+
+std::string ReadFile(const fs::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        throw std::runtime_error("Can't open file "s + path.string());
+    }
+    std::string content(fs::file_size(path), '\0');
+    file.read(content.data(), static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<std::size_t>(file.gcount()));
+    return content;
+}
+
+std::shared_ptr<const StaticAsset> LoadAsset(const fs::path& path) {
+    auto asset = std::make_shared<StaticAsset>();
+    asset->content_type = GetContentType(path.string());
+    asset->write_time = fs::last_write_time(path);
+    asset->file_size = fs::file_size(path);
+    asset->last_modified = HttpDate(asset->write_time);
+
+    auto content = std::make_shared<const std::string>(ReadFile(path));
+    asset->identity.etag = MakeETag(*content);
+
+    if (content->size() <= UINT_MAX) {
+        if (auto gzip = Gzip(*content); WorthKeeping(gzip, *content)) {
+            asset->gzip.etag = VariantETag(asset->identity.etag, "-gz"sv);
+            asset->gzip.body = std::make_shared<const std::string>(std::move(gzip));
+        }
+        if (auto brotli = Brotli(*content, asset->content_type); WorthKeeping(brotli, *content)) {
+            asset->brotli.etag = VariantETag(asset->identity.etag, "-br"sv);
+            asset->brotli.body = std::make_shared<const std::string>(std::move(brotli));
+        }
+    }
+    if (content->size() > StaticCache::kMaxInMemorySize) {
+        asset->identity.file = http_server::FileDescriptor::Open(path);
+    } else {
+        asset->identity.body = std::move(content);
+    }
+    return asset;
+}
+
+bool IsWithinRoot(const fs::path& path, const fs::path& root) {
+    auto p_it = path.begin();
+    for (auto r_it = root.begin(); r_it != root.end(); ++r_it, ++p_it) {
+        if (p_it == path.end() || *p_it != *r_it) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+SelectedVariant SelectVariant(const StaticAsset& asset, const Fields& headers) {
+    if (auto it = headers.find(http::field::accept_encoding); it != headers.end()) {
+        if (asset.brotli && ListAccepts(it->value(), "br"sv)) {
+            return {&asset.brotli, ContentCoding::Brotli};
+        }
+        if (asset.gzip && ListAccepts(it->value(), "gzip"sv)) {
+            return {&asset.gzip, ContentCoding::Gzip};
+        }
+    }
+    return {&asset.identity, ContentCoding::Identity};
+}
+
+// Перечитывает каталог после изменений. Редактор сохраняет файл несколькими операциями,
+// поэтому перезагрузка откладывается, пока события не стихнут. Сама перезагрузка идёт
+// в собственном потоке: сжатие большого файла заняло бы поток ioc на сотни миллисекунд.
+class StaticCache::Watcher {
+   public:
+    Watcher(StaticCache& cache, net::io_context& ioc)
+        : cache_{cache}, strand_{net::make_strand(ioc)}, events_{strand_}, debounce_{strand_} {
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "inotify_init1");
+        }
+        events_.assign(fd);
+        AddWatches();
+        Read();
+    }
+
+   private:
+    // inotify не следит за подкаталогами, поэтому каждый каталог добавляется отдельно.
+    // Повторное добавление уже наблюдаемого каталога ничего не меняет.
+    void AddWatches() {
+        constexpr std::uint32_t kMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                        IN_MOVED_TO | IN_ATTRIB;
+        const int fd = events_.native_handle();
+        inotify_add_watch(fd, cache_.root_.c_str(), kMask);
+
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it{cache_.root_, ec}, end; !ec && it != end;
+             it.increment(ec)) {
+            if (it->is_directory(ec)) {
+                inotify_add_watch(fd, it->path().c_str(), kMask);
+            }
+        }
+    }
+
+    void Read() {
+        events_.async_read_some(net::buffer(buffer_), [this](sys::error_code ec, std::size_t) {
+            if (ec) {
+                return;
+            }
+            debounce_.expires_after(std::chrono::milliseconds{200});
+            debounce_.async_wait([this](sys::error_code ec) {
+                if (!ec) {
+                    net::post(reload_pool_, [this] {
+                        Reload();
+                    });
+                }
+            });
+            Read();
+        });
+    }
+
+    void Reload() {
+        try {
+            AddWatches();
+            cache_.Reload();
+        } catch (const std::exception& e) {
+            // Файл мог исчезнуть во время чтения: остаются прежние данные до следующего события
+            boost::json::object data;
+            data["root"] = cache_.root_.string();
+            data["exception"] = e.what();
+
+            BOOST_LOG_TRIVIAL(error) << boost::log::add_value(app_logging::additional_data,
+                                                              boost::json::value(std::move(data)))
+                                     << "static files reload failed"sv;
+        }
+    }
+
+    StaticCache& cache_;
+    net::strand<net::io_context::executor_type> strand_;
+    net::posix::stream_descriptor events_;
+    net::steady_timer debounce_;
+    std::array<char, 4096> buffer_;
+    // Один поток: перезагрузки выполняются по очереди. Объявлен последним, чтобы при
+    // разрушении дождаться идущей перезагрузки, пока остальные поля ещё живы
+    net::thread_pool reload_pool_{1};
+};
+
+StaticCache::StaticCache(fs::path root) : root_{std::move(root)}, index_{LoadIndex(nullptr)} {}
+
+StaticCache::~StaticCache() = default;
+
+std::shared_ptr<const StaticAsset> StaticCache::Find(std::string_view path) const {
+    const auto index = std::atomic_load_explicit(&index_, std::memory_order_acquire);
+    if (auto it = index->find(path); it != index->end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+void StaticCache::Reload() {
+    const auto previous = std::atomic_load_explicit(&index_, std::memory_order_acquire);
+    std::atomic_store_explicit(&index_, LoadIndex(previous.get()), std::memory_order_release);
+}
+
+void StaticCache::WatchChanges(net::io_context& ioc) {
+    watcher_ = std::make_unique<Watcher>(*this, ioc);
+}
+
+std::shared_ptr<const StaticCache::Index> StaticCache::LoadIndex(const Index* previous) const {
+    auto index = std::make_shared<Index>();
+    for (const auto& entry : fs::recursive_directory_iterator{root_}) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        // Ссылки, ведущие за пределы корня, не раздаются
+        if (!IsWithinRoot(fs::canonical(entry.path()), root_)) {
+            continue;
+        }
+        auto key = entry.path().lexically_relative(root_).generic_string();
+        if (previous) {
+            if (auto it = previous->find(key); it != previous->end() &&
+                                               it->second->write_time == entry.last_write_time() &&
+                                               it->second->file_size == entry.file_size()) {
+                index->emplace(std::move(key), it->second);
+                continue;
+            }
+        }
+        index->emplace(std::move(key), LoadAsset(entry.path()));
+    }
+    return index;
+}
+
+}  // namespace http_handler
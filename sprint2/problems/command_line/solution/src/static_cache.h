@@ -0,0 +1,95 @@
+#pragma once
+#include <boost/asio/io_context.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "http_types.h"
+
+namespace http_handler {
+namespace fs = std::filesystem;
+
+// Один вариант кодирования файла и его ETag. Тело хранится в памяти (body) или, для
+// больших файлов, отдаётся через sendfile из заранее открытого файла (file)
+struct AssetVariant {
+    std::shared_ptr<const std::string> body;
+    std::shared_ptr<const http_server::FileDescriptor> file;
+    std::string etag;
+
+    explicit operator bool() const noexcept { return body || file; }
+
+    std::uint64_t Size() const noexcept { return body ? body->size() : file ? file->Size() : 0; }
+};
+
+struct StaticAsset {
+    std::string_view content_type;
+    std::string last_modified;  // HTTP-date
+    AssetVariant identity;
+    // Сжатые варианты есть, только если сжатие заметно уменьшает файл
+    AssetVariant gzip;
+    AssetVariant brotli;
+    // По ним перезагрузка узнаёт, что файл не менялся и его можно не сжимать заново
+    fs::file_time_type write_time;
+    std::uint64_t file_size = 0;
+};
+
+enum class ContentCoding { Identity, Gzip, Brotli };
+
+struct SelectedVariant {
+    const AssetVariant* variant;
+    ContentCoding coding;
+};
+
+// Выбирает вариант по заголовку Accept-Encoding: brotli, затем gzip, затем исходный файл
+SelectedVariant SelectVariant(const StaticAsset& asset, const Fields& headers);
+
+// Содержимое каталога статических файлов, загруженное в память при старте.
+// Ключ - путь относительно корня с разделителями '/', например "js/three.js".
+// Файлы больше kMaxInMemorySize держатся открытыми, а в памяти остаются только
+// их сжатые варианты.
+class StaticCache {
+   public:
+    static constexpr std::uint64_t kMaxInMemorySize = 256 * 1024;
+
+    explicit StaticCache(fs::path root);
+    ~StaticCache();
+
+    StaticCache(const StaticCache&) = delete;
+    StaticCache& operator=(const StaticCache&) = delete;
+
+    std::shared_ptr<const StaticAsset> Find(std::string_view path) const;
+
+    // Перечитывает каталог. Заново читаются и сжимаются только изменившиеся файлы.
+    // Запросы, начатые до перезагрузки, дообслуживаются старыми данными
+    void Reload();
+
+    // Перечитывает каталог при изменениях в нём (inotify) в отдельном потоке, чтобы сжатие
+    // не занимало потоки ioc. Вызывается один раз
+    void WatchChanges(boost::asio::io_context& ioc);
+
+    const fs::path& GetRoot() const noexcept { return root_; }
+
+   private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+    using Index =
+        std::unordered_map<std::string, std::shared_ptr<const StaticAsset>, StringHash, std::equal_to<>>;
+
+    class Watcher;
+
+    // Файлы, у которых не изменились время записи и размер, берутся из previous
+    std::shared_ptr<const Index> LoadIndex(const Index* previous) const;
+
+    fs::path root_;
+    std::shared_ptr<const Index> index_;
+    std::unique_ptr<Watcher> watcher_;
+};
+
+}  // namespace http_handler
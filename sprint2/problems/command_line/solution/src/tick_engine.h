@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <cstddef>
+#include <exception>
+#include <latch>
+#include <mutex>
+#include <optional>
+
+namespace app {
+
+// Раздаёт независимые задачи тика (по одной на игровую сессию) пулу потоков
+// и дожидается завершения всех задач, прежде чем вернуть управление.
+class TickEngine {
+   public:
+    // threads - общее число потоков, считая вызывающий Run
+    explicit TickEngine(unsigned threads) : threads_{std::max(1u, threads)} {
+        if (threads_ > 1) {
+            pool_.emplace(threads_ - 1);
+        }
+    }
+
+    TickEngine(const TickEngine&) = delete;
+    TickEngine& operator=(const TickEngine&) = delete;
+
+    ~TickEngine() {
+        if (pool_) {
+            pool_->join();
+        }
+    }
+
+    // Вызывает fn(i) для каждого i из [0, count). Вызывающий поток тоже обрабатывает задачи.
+    // Исключение, выброшенное любой из задач, перебрасывается после барьера.
+    template <typename Fn>
+    void Run(std::size_t count, Fn&& fn) {
+        const std::size_t helpers = pool_ ? std::min<std::size_t>(threads_, count) - 1 : 0;
+        if (helpers == 0) {
+            for (std::size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        // Потоки забирают задачи по одной, поэтому крупные сессии не тормозят остальные
+        auto drain = [&] {
+            for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    std::lock_guard lock{error_mutex};
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        std::latch done{static_cast<std::ptrdiff_t>(helpers)};
+        for (std::size_t i = 0; i < helpers; ++i) {
+            boost::asio::post(*pool_, [&] {
+                drain();
+                done.count_down();
+            });
+        }
+        drain();
+        done.wait();
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+   private:
+    unsigned threads_;
+    std::optional<boost::asio::thread_pool> pool_;
+};
+
+}  // namespace app
@@ -1,4 +1,9 @@
 #include <boost/asio.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "metrics.h"
 
 namespace net = boost::asio;
 namespace sys = boost::system;
@@ -8,42 +13,100 @@ class Ticker : public std::enable_shared_from_this<Ticker> {
     using Strand = net::strand<net::io_context::executor_type>;
     using Handler = std::function<void(std::chrono::milliseconds delta)>;
 
-    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
-        : strand_{strand}, period_{period}, handler_{std::move(handler)} {}
+    enum class Mode {
+        // Таймер заводится после обработки тика, handler получает фактически прошедшее время
+        Elastic,
+        // Тики идут по абсолютному расписанию, handler всегда получает ровно period.
+        // Опоздавшие тики догоняются, но не больше kMaxCatchUpSteps за раз.
+        Fixed
+    };
+
+    static constexpr std::uint64_t kMaxCatchUpSteps = 5;
+
+    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler,
+           Mode mode = Mode::Elastic)
+        : strand_{strand}, period_{period}, handler_{std::move(handler)}, mode_{mode} {
+        if (period_ <= std::chrono::milliseconds::zero()) {
+            throw std::invalid_argument("Tick period must be positive");
+        }
+    }
 
     void Start() {
         last_tick_ = Clock::now();
+        next_deadline_ = last_tick_ + period_;
         net::dispatch(strand_, [self = shared_from_this()] { self->ScheduleTick(); });
     }
 
    private:
+    using Clock = std::chrono::steady_clock;
+
     void ScheduleTick() {
         assert(strand_.running_in_this_thread());
-        timer_.expires_after(period_);
+        if (mode_ == Mode::Fixed) {
+            timer_.expires_at(next_deadline_);
+        } else {
+            timer_.expires_after(period_);
+        }
         timer_.async_wait([self = shared_from_this()](sys::error_code ec) { self->OnTick(ec); });
     }
 
     void OnTick(sys::error_code ec) {
-        using namespace std::chrono;
         assert(strand_.running_in_this_thread());
 
         if (!ec) {
-            auto this_tick = Clock::now();
-            auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
-            last_tick_ = this_tick;
-            try {
-                handler_(delta);
-            } catch (...) {
+            if (mode_ == Mode::Fixed) {
+                RunFixedSteps();
+            } else {
+                RunElasticTick();
             }
             ScheduleTick();
         }
     }
 
-    using Clock = std::chrono::steady_clock;
+    void RunElasticTick() {
+        using namespace std::chrono;
+
+        auto this_tick = Clock::now();
+        auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
+        const auto lag = std::max(Clock::duration::zero(), this_tick - last_tick_ - period_);
+        last_tick_ = this_tick;
+        Invoke(delta);
+        app_metrics::RecordTick(Clock::now() - this_tick, lag);
+        app_metrics::RecordTickSchedule(1, 0, 0);
+    }
+
+    // Выполняет все тики, срок которых наступил. Если сервер отстал больше чем на
+    // kMaxCatchUpSteps тиков, лишние пропускаются: расписание сдвигается, а модель не получает
+    // один большой шаг, который исказил бы движение.
+    void RunFixedSteps() {
+        const auto now = Clock::now();
+        const auto lag = std::max(Clock::duration::zero(), now - next_deadline_);
+        const std::uint64_t due = 1 + static_cast<std::uint64_t>(lag / period_);
+        const std::uint64_t steps = std::min(due, kMaxCatchUpSteps);
+
+        for (std::uint64_t i = 0; i < steps; ++i) {
+            Invoke(period_);
+        }
+        next_deadline_ += period_ * static_cast<std::int64_t>(due);
+        last_tick_ = now;
+
+        app_metrics::RecordTick(Clock::now() - now, lag);
+        // Первый шаг выполняется в срок, остальные догоняют; пропущенные не выполнялись вовсе
+        app_metrics::RecordTickSchedule(steps, steps - 1, due - steps);
+    }
+
+    void Invoke(std::chrono::milliseconds delta) {
+        try {
+            handler_(delta);
+        } catch (...) {
+        }
+    }
 
     Strand strand_;
     std::chrono::milliseconds period_;
     net::steady_timer timer_{strand_};
     Handler handler_;
-    std::chrono::steady_clock::time_point last_tick_;
-};
\ No newline at end of file
+    Mode mode_;
+    Clock::time_point last_tick_;
+    Clock::time_point next_deadline_;
+};
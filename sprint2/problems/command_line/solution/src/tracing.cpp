@@ -0,0 +1,206 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace app_tracing {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}  // namespace detail
+
+namespace {
+
+// Поля атомарные, потому что выгрузка читает буфер, пока поток-владелец продолжает писать
+struct Event {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<std::int64_t> start_ns{0};
+    std::atomic<std::int64_t> duration_ns{0};
+    std::atomic<std::int64_t> arg{0};
+    std::atomic<std::uint64_t> async_id{0};
+};
+
+struct EventCopy {
+    const char* name;
+    std::int64_t start_ns;
+    std::int64_t duration_ns;
+    std::int64_t arg;
+    std::uint64_t async_id;
+};
+
+// Кольцевой буфер одного писателя. Читатель копирует события и затем отбрасывает те,
+// ячейки которых писатель мог занять за время копирования (как в seqlock)
+class Ring {
+   public:
+    Ring(std::size_t capacity, unsigned tid)
+        : events_{std::make_unique<Event[]>(capacity)}, capacity_{capacity}, tid_{tid} {}
+
+    void Push(const EventCopy& event) noexcept {
+        const std::uint64_t pos = head_.load(std::memory_order_relaxed);
+        // Читатель, увидевший любое из полей ниже, увидит и head_ >= pos
+        std::atomic_thread_fence(std::memory_order_release);
+        Event& slot = events_[pos & (capacity_ - 1)];
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+        slot.duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+        slot.arg.store(event.arg, std::memory_order_relaxed);
+        slot.async_id.store(event.async_id, std::memory_order_relaxed);
+        head_.store(pos + 1, std::memory_order_release);
+    }
+
+    std::vector<EventCopy> Copy() const {
+        const std::uint64_t end = head_.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+
+        std::vector<EventCopy> events;
+        events.reserve(end - begin);
+        for (std::uint64_t i = begin; i < end; ++i) {
+            const Event& slot = events_[i & (capacity_ - 1)];
+            events.push_back({slot.name.load(std::memory_order_relaxed),
+                              slot.start_ns.load(std::memory_order_relaxed),
+                              slot.duration_ns.load(std::memory_order_relaxed),
+                              slot.arg.load(std::memory_order_relaxed),
+                              slot.async_id.load(std::memory_order_relaxed)});
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = head_.load(std::memory_order_relaxed);
+        // Ячейку события after - capacity_ писатель мог начать перезаписывать
+        const std::uint64_t first_valid = after >= capacity_ ? after - capacity_ + 1 : 0;
+        if (first_valid > begin) {
+            events.erase(events.begin(),
+                         events.begin() + static_cast<std::ptrdiff_t>(
+                                              std::min<std::uint64_t>(first_valid - begin,
+                                                                      events.size())));
+        }
+        return events;
+    }
+
+    unsigned Tid() const noexcept { return tid_; }
+
+   private:
+    std::unique_ptr<Event[]> events_;
+    const std::size_t capacity_;
+    const unsigned tid_;
+    std::atomic<std::uint64_t> head_{0};
+};
+
+class Registry {
+   public:
+    Ring& Register() {
+        std::lock_guard lock{mutex_};
+        const auto tid = static_cast<unsigned>(rings_.size() + 1);
+        return *rings_.emplace_back(std::make_unique<Ring>(capacity_, tid));
+    }
+
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        std::lock_guard lock{mutex_};
+        for (const auto& ring : rings_) {
+            fn(*ring);
+        }
+    }
+
+    std::size_t capacity_ = 0;
+    Clock::time_point epoch_;
+
+   private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+Ring& LocalRing() {
+    thread_local Ring& ring = GetRegistry().Register();
+    return ring;
+}
+
+std::atomic<std::uint64_t> next_async_id{1};
+
+// "api.state" -> "api"
+std::string_view Category(std::string_view name) {
+    return name.substr(0, name.find('.'));
+}
+
+void WriteEvent(std::ostream& out, char phase, const char* name, unsigned tid, std::int64_t ts_ns,
+                const EventCopy& event) {
+    char buffer[256];
+    int size = std::snprintf(buffer, sizeof(buffer),
+                             ",\n{\"ph\":\"%c\",\"name\":\"%s\",\"cat\":\"%.*s\",\"pid\":1,"
+                             "\"tid\":%u,\"ts\":%.3f",
+                             phase, name, static_cast<int>(Category(name).size()),
+                             Category(name).data(), tid, static_cast<double>(ts_ns) / 1000.0);
+    out.write(buffer, size);
+
+    if (phase == 'X') {
+        size = std::snprintf(buffer, sizeof(buffer), ",\"dur\":%.3f",
+                             static_cast<double>(event.duration_ns) / 1000.0);
+        out.write(buffer, size);
+    } else {
+        size = std::snprintf(buffer, sizeof(buffer), ",\"id\":\"0x%llx\"",
+                             static_cast<unsigned long long>(event.async_id));
+        out.write(buffer, size);
+    }
+    if (event.arg != 0 && phase != 'e') {
+        size = std::snprintf(buffer, sizeof(buffer), ",\"args\":{\"value\":%lld}",
+                             static_cast<long long>(event.arg));
+        out.write(buffer, size);
+    }
+    out << '}';
+}
+
+}  // namespace
+
+void Enable(std::size_t events_per_thread) {
+    auto& registry = GetRegistry();
+    registry.capacity_ = std::bit_ceil(std::max<std::size_t>(events_per_thread, 2));
+    registry.epoch_ = Clock::now();
+    detail::enabled.store(true, std::memory_order_release);
+}
+
+std::uint64_t NextAsyncId() noexcept {
+    return next_async_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Record(const char* name, Clock::time_point start, Clock::time_point end, std::int64_t arg,
+            std::uint64_t async_id) noexcept {
+    if (start == Clock::time_point{} || !detail::enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+    const auto epoch = GetRegistry().epoch_;
+    LocalRing().Push({name, (start - epoch).count(), (end - start).count(), arg, async_id});
+}
+
+void WriteChromeTrace(std::ostream& out) {
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+           "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,"
+           "\"args\":{\"name\":\"game_server\"}}";
+
+    GetRegistry().ForEach([&out](const Ring& ring) {
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << ring.Tid()
+            << ",\"args\":{\"name\":\"thread " << ring.Tid() << "\"}}";
+
+        for (const EventCopy& event : ring.Copy()) {
+            if (event.async_id == 0) {
+                WriteEvent(out, 'X', event.name, ring.Tid(), event.start_ns, event);
+            } else {
+                WriteEvent(out, 'b', event.name, ring.Tid(), event.start_ns, event);
+                WriteEvent(out, 'e', event.name, ring.Tid(), event.start_ns + event.duration_ns,
+                           event);
+            }
+        }
+    });
+
+    out << "\n]}\n";
+}
+
+}  // namespace app_tracing
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Трассировка обработки запросов и тиков в формате Chrome trace events (chrome://tracing,
+// ui.perfetto.dev). Каждый поток пишет завершённые интервалы в свой кольцевой буфер без
+// блокировок; при выгрузке буферы всех потоков собираются в один JSON. Буферы хранят
+// последние события, поэтому выгрузка показывает окно непосредственно перед ней.
+namespace app_tracing {
+
+using Clock = std::chrono::steady_clock;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}  // namespace detail
+
+// Включает запись событий. Пока трассировка выключена, интервал стоит одной проверки флага.
+void Enable(std::size_t events_per_thread = 1 << 15);
+
+inline bool IsEnabled() noexcept {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Текущее время, если трассировка включена, иначе нулевая отметка (её Record пропускает)
+inline Clock::time_point Now() noexcept {
+    return IsEnabled() ? Clock::now() : Clock::time_point{};
+}
+
+// Идентификатор для интервалов, которые начинаются и заканчиваются в разных потоках
+std::uint64_t NextAsyncId() noexcept;
+
+// name - строковый литерал вида "категория.имя". async_id == 0 - интервал выполнялся
+// в текущем потоке, иначе это асинхронный интервал (например, ожидание в strand):
+// интервалы с одним именем и async_id показываются на одной дорожке.
+void Record(const char* name, Clock::time_point start, Clock::time_point end,
+            std::int64_t arg = 0, std::uint64_t async_id = 0) noexcept;
+
+// Интервал от создания объекта до выхода из области видимости
+class Span {
+   public:
+    explicit Span(const char* name, std::int64_t arg = 0) noexcept
+        : name_{name}, arg_{arg}, start_{Now()} {}
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    ~Span() {
+        if (start_ != Clock::time_point{}) {
+            Record(name_, start_, Clock::now(), arg_);
+        }
+    }
+
+    void SetArg(std::int64_t arg) noexcept { arg_ = arg; }
+
+   private:
+    const char* name_;
+    std::int64_t arg_;
+    Clock::time_point start_;
+};
+
+// Записывает содержимое буферов всех потоков в формате Chrome trace events
+void WriteChromeTrace(std::ostream& out);
+
+}  // namespace app_tracing
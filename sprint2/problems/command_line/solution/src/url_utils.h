@@ -3,6 +3,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 
 using namespace std::literals;
 
@@ -16,8 +17,11 @@ struct Endpoint {
     constexpr static std::string_view JOIN = "/api/v1/game/join"sv;
     constexpr static std::string_view PLAYERS = "/api/v1/game/players"sv;
     constexpr static std::string_view STATE = "/api/v1/game/state"sv;
+    constexpr static std::string_view STATE_STREAM = "/api/v1/game/state/stream"sv;
     constexpr static std::string_view ACTION = "/api/v1/game/player/action"sv;
     constexpr static std::string_view TICK = "/api/v1/game/tick"sv;
+
+    constexpr static std::string_view METRICS = "/metrics"sv;
 };
 
 namespace url {
@@ -44,6 +48,31 @@ inline std::optional<std::string_view> ExtractMapId(std::string_view target) {
     return target.substr(Endpoint::MAPS.size() + 1);
 }
 
+// Разделяет target на путь и строку запроса (без '?')
+inline std::pair<std::string_view, std::string_view> SplitQuery(std::string_view target) {
+    const auto pos = target.find('?');
+    if (pos == std::string_view::npos) {
+        return {target, {}};
+    }
+    return {target.substr(0, pos), target.substr(pos + 1)};
+}
+
+inline std::optional<std::string_view> FindQueryParam(std::string_view query,
+                                                      std::string_view name) {
+    while (!query.empty()) {
+        const auto amp = query.find('&');
+        const std::string_view param = query.substr(0, amp);
+        if (param.size() > name.size() && param.starts_with(name) && param[name.size()] == '=') {
+            return param.substr(name.size() + 1);
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(amp + 1);
+    }
+    return std::nullopt;
+}
+
 inline int HexVal(unsigned char c) {
     if (c >= '0' && c <= '9') return c - '0';
     if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
@@ -75,6 +75,8 @@ class GameState {
     this.playersUpdateInterval = 50;
     this.keyState = new KeyState();
     this.currentState = {};
+    this.streaming = false;
+    this.streamPlayers = {};
 
     this._updateState(function() {
       self.stateLoaded = true;
@@ -84,6 +86,7 @@ class GameState {
       self.playersLoaded = true;
       self._startGame();
     });
+    this._openStream();
   }
 
   tick() {
@@ -94,7 +97,7 @@ class GameState {
     if (!this.started)
       return false;
 
-    if (this.ticks % this.posUpdateInterval == 0 && !this.updateInProgress) {
+    if (!this.streaming && this.ticks % this.posUpdateInterval == 0 && !this.updateInProgress) {
       this._updateState(function() {
         self._applyDesiredState();
         self._instantApplyState();
@@ -257,6 +260,49 @@ class GameState {
     })
   }
 
+  // The server sends one full frame, then only the dogs that changed on each tick.
+  // Polling of /api/v1/game/state is paused while the stream is open.
+  _openStream() {
+    if (typeof WebSocket === 'undefined') {
+      return;
+    }
+
+    let self = this;
+    const proto = location.protocol === 'https:' ? 'wss://' : 'ws://';
+    const socket = new WebSocket(proto + location.host + '/api/v1/game/state/stream?token=' +
+                                 encodeURIComponent(Cookies.get('authToken')));
+
+    socket.onopen = function() {
+      self.streaming = true;
+    };
+    socket.onclose = function() {
+      self.streaming = false;
+    };
+    socket.onmessage = function(event) {
+      const frame = JSON.parse(event.data);
+      if (frame.full) {
+        self.streamPlayers = {};
+      }
+      Object.assign(self.streamPlayers, frame.players);
+
+      if (!self.started) {
+        return;
+      }
+
+      const players = {};
+      Object.entries(self.streamPlayers).forEach(([id, p]) => {
+        players[id] = {pos: p.pos.slice(), speed: p.speed.slice(), dir: p.dir};
+        if (self.players[id] === undefined && !self.playersSuncInProgress) {
+          self._syncPlayers(function(){});
+        }
+      });
+      self.desiredState = {players: players};
+      self.stateTime = performance.now();
+      self._applyDesiredState();
+      self._instantApplyState();
+    };
+  }
+
   _applyDesiredState() {
     const old_players = this.currentState['players'] !== undefined ? this.currentState['players'] : {};
     const new_players = {};
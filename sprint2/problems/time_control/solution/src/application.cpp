@@ -81,7 +81,7 @@ std::optional<std::vector<int>> Application::GetPlayers(std::string_view token)
 }
 
 void Application::Move(double dt) {
-    auto maps = GetMaps();
+    const auto& maps = GetMaps();
     for (const auto& map : maps) {
         auto session = game_.GetSession(map.GetId());
         if (session) {
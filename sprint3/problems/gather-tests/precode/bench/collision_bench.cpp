@@ -0,0 +1,189 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "../src/collision_batch.h"
+#include "../src/collision_detector.h"
+
+using namespace collision_detector;
+
+namespace {
+
+constexpr double kMapSize = 1000.;
+constexpr double kMaxStep = 3.;  // скорость 30 за тик 100 мс
+constexpr double kGathererWidth = 0.6;
+
+class Provider : public ItemGathererProvider {
+public:
+    // Предметы и собиратели разбросаны по квадрату map_size x map_size
+    Provider(size_t item_count, size_t gatherer_count, double map_size = kMapSize) {
+        std::mt19937 gen{42};
+        std::uniform_real_distribution<double> coord{0., map_size};
+        std::uniform_real_distribution<double> step{-kMaxStep, kMaxStep};
+
+        items_.reserve(item_count);
+        for (size_t i = 0; i < item_count; ++i) {
+            items_.push_back({{coord(gen), coord(gen)}, 0.});
+        }
+        // Собаки ходят вдоль дорог, поэтому смещение только по одной оси
+        gatherers_.reserve(gatherer_count);
+        for (size_t g = 0; g < gatherer_count; ++g) {
+            const geom::Point2D start{coord(gen), coord(gen)};
+            const double distance = step(gen);
+            const geom::Vec2D move = g % 2 ? geom::Vec2D{distance, 0.} : geom::Vec2D{0., distance};
+            gatherers_.push_back({start, start + move, kGathererWidth});
+        }
+    }
+
+    size_t ItemsCount() const override {
+        return items_.size();
+    }
+    Item GetItem(size_t idx) const override {
+        return items_[idx];
+    }
+    size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+    Gatherer GetGatherer(size_t idx) const override {
+        return gatherers_[idx];
+    }
+
+private:
+    std::vector<Item> items_;
+    std::vector<Gatherer> gatherers_;
+};
+
+// Прежний способ: каждый собиратель проверяет каждый предмет
+std::vector<GatheringEvent> FindGatherEventsNaive(const ItemGathererProvider& provider) {
+    std::vector<GatheringEvent> events;
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        const Gatherer gatherer = provider.GetGatherer(g);
+        if (gatherer.start_pos == gatherer.end_pos) {
+            continue;
+        }
+        for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+            const Item item = provider.GetItem(i);
+            const auto result =
+                TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            if (result.IsCollected(gatherer.width + item.width)) {
+                events.push_back({i, g, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.time < rhs.time;
+    });
+    return events;
+}
+
+template <typename Find>
+void Gather(benchmark::State& state, Find&& find) {
+    const Provider provider{static_cast<size_t>(state.range(0)),
+                            static_cast<size_t>(state.range(1))};
+    size_t events = 0;
+    for (auto _ : state) {
+        auto result = find(provider);
+        events = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    state.counters["events"] = static_cast<double>(events);
+}
+
+void BM_FindGatherEvents(benchmark::State& state) {
+    Gather(state, FindGatherEvents);
+}
+BENCHMARK(BM_FindGatherEvents)
+    ->Args({10'000, 1'000})
+    ->Args({100'000, 10'000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_FindGatherEventsNaive(benchmark::State& state) {
+    Gather(state, FindGatherEventsNaive);
+}
+BENCHMARK(BM_FindGatherEventsNaive)
+    ->Args({10'000, 1'000})
+    ->Args({100'000, 10'000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Один ход против state.range(0) предметов подряд, state.range(1) - номер BatchKernel
+void BM_TryCollectPoints(benchmark::State& state) {
+    const auto kernel = static_cast<BatchKernel>(state.range(1));
+    if (kernel == BatchKernel::Avx2 && DetectBatchKernel() != BatchKernel::Avx2) {
+        state.SkipWithError("AVX2 is not supported");
+        return;
+    }
+
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<double> coord{0., 10.};
+    std::vector<double> x(count), y(count), width(count, 0.);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = coord(gen);
+        y[i] = coord(gen);
+    }
+    std::vector<double> sq_distance(count), proj_ratio(count);
+    std::vector<uint64_t> hits((count + 63) / 64);
+
+    for (auto _ : state) {
+        TryCollectPoints(kernel, {2., 5.}, {5., 5.}, kGathererWidth,
+                         {x.data(), y.data(), width.data(), count}, sq_distance.data(),
+                         proj_ratio.data(), hits.data());
+        benchmark::DoNotOptimize(hits.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TryCollectPoints)->ArgsProduct({{16, 1'024, 100'000}, {0, 1}});
+
+// Узкая фаза на скопившихся предметах: в каждую ячейку сетки попадает много предметов
+void BM_FindGatherEventsDense(benchmark::State& state) {
+    const Provider provider{static_cast<size_t>(state.range(0)),
+                            static_cast<size_t>(state.range(1)), kMapSize / 20};
+    size_t events = 0;
+    for (auto _ : state) {
+        auto result = FindGatherEvents(provider);
+        events = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    state.counters["events"] = static_cast<double>(events);
+}
+BENCHMARK(BM_FindGatherEventsDense)
+    ->Args({100'000, 10'000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Тик игры: state.range(1) собак ходят по карте с state.range(0) предметами, которые
+// лежат в CollisionWorld между тиками. Время растёт только с плотностью предметов
+// рядом с собаками, а не с их общим числом.
+void BM_CollisionWorldTick(benchmark::State& state) {
+    const Provider provider{static_cast<size_t>(state.range(0)),
+                            static_cast<size_t>(state.range(1))};
+    CollisionWorld world;
+    for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+        world.AddItem(provider.GetItem(i));
+    }
+    std::vector<Gatherer> gatherers;
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        gatherers.push_back(provider.GetGatherer(g));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(world.FindGatherEvents(gatherers));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_CollisionWorldTick)->ArgsProduct({{10'000, 100'000, 1'000'000}, {100, 10'000}});
+
+// То же с построением индекса на каждом тике
+void BM_FindGatherEventsTick(benchmark::State& state) {
+    Gather(state, FindGatherEvents);
+}
+BENCHMARK(BM_FindGatherEventsTick)->ArgsProduct({{10'000, 100'000, 1'000'000}, {100, 10'000}});
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+#include "collision_batch.h"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLLISION_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace collision_detector {
+
+namespace {
+
+// Формулы и порядок операций те же, что в TryCollectPoint и CollectionResult::IsCollected.
+// Библиотека собирается с -ffp-contract=off, чтобы компилятор не заменял их на FMA.
+struct Move {
+    Move(geom::Point2D a, geom::Point2D b, double width)
+        : a_x(a.x)
+        , a_y(a.y)
+        , v_x(b.x - a.x)
+        , v_y(b.y - a.y)
+        , v_len2(v_x * v_x + v_y * v_y)
+        , width(width) {
+    }
+
+    double a_x, a_y, v_x, v_y, v_len2, width;
+};
+
+void CollectScalar(const Move& move, const ItemSpan& items, size_t first, double* sq_distance,
+                   double* proj_ratio, uint64_t* hits) {
+    for (size_t i = first; i < items.size; ++i) {
+        const double u_x = items.x[i] - move.a_x;
+        const double u_y = items.y[i] - move.a_y;
+        const double u_dot_v = u_x * move.v_x + u_y * move.v_y;
+        const double u_len2 = u_x * u_x + u_y * u_y;
+        const double proj = u_dot_v / move.v_len2;
+        const double sq = u_len2 - (u_dot_v * u_dot_v) / move.v_len2;
+        const double radius = move.width + items.width[i];
+
+        sq_distance[i] = sq;
+        proj_ratio[i] = proj;
+        if (proj >= 0 && proj <= 1 && sq <= radius * radius) {
+            hits[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+}
+
+#ifdef COLLISION_BATCH_X86
+
+// Четыре предмета за итерацию, хвост досчитывается скалярно
+__attribute__((target("avx2"))) void CollectAvx2(const Move& move, const ItemSpan& items,
+                                                 double* sq_distance, double* proj_ratio,
+                                                 uint64_t* hits) {
+    const __m256d a_x = _mm256_set1_pd(move.a_x);
+    const __m256d a_y = _mm256_set1_pd(move.a_y);
+    const __m256d v_x = _mm256_set1_pd(move.v_x);
+    const __m256d v_y = _mm256_set1_pd(move.v_y);
+    const __m256d v_len2 = _mm256_set1_pd(move.v_len2);
+    const __m256d width = _mm256_set1_pd(move.width);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    // Записи в hits могли бы менять items с точки зрения компилятора, поэтому указатели
+    // копируются, чтобы не перечитывать их на каждой итерации
+    const double* const x = items.x;
+    const double* const y = items.y;
+    const double* const item_width = items.width;
+    const size_t size = items.size;
+
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(x + i), a_x);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(y + i), a_y);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, v_x), _mm256_mul_pd(u_y, v_y));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj = _mm256_div_pd(u_dot_v, v_len2);
+        const __m256d sq =
+            _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2));
+        const __m256d radius = _mm256_add_pd(width, _mm256_loadu_pd(item_width + i));
+
+        _mm256_storeu_pd(sq_distance + i, sq);
+        _mm256_storeu_pd(proj_ratio + i, proj);
+
+        const __m256d collected =
+            _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(proj, zero, _CMP_GE_OQ),
+                                        _mm256_cmp_pd(proj, one, _CMP_LE_OQ)),
+                          _mm256_cmp_pd(sq, _mm256_mul_pd(radius, radius), _CMP_LE_OQ));
+        // i кратно 4, поэтому четыре бита не пересекают границу слова
+        hits[i / 64] |= static_cast<uint64_t>(_mm256_movemask_pd(collected)) << (i % 64);
+    }
+    // Хвост считается SSE-кодом: без сброса верхних половин регистров каждая его
+    // инструкция платит за переход между AVX и SSE
+    _mm256_zeroupper();
+    CollectScalar(move, items, i, sq_distance, proj_ratio, hits);
+}
+
+#endif  // COLLISION_BATCH_X86
+
+}  // namespace
+
+BatchKernel DetectBatchKernel() noexcept {
+#ifdef COLLISION_BATCH_X86
+    static const BatchKernel kernel =
+        __builtin_cpu_supports("avx2") ? BatchKernel::Avx2 : BatchKernel::Scalar;
+    return kernel;
+#else
+    return BatchKernel::Scalar;
+#endif
+}
+
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, double width, const ItemSpan& items,
+                      double* sq_distance, double* proj_ratio, uint64_t* hits) {
+    TryCollectPoints(DetectBatchKernel(), a, b, width, items, sq_distance, proj_ratio, hits);
+}
+
+void TryCollectPoints(BatchKernel kernel, geom::Point2D a, geom::Point2D b, double width,
+                      const ItemSpan& items, double* sq_distance, double* proj_ratio,
+                      uint64_t* hits) {
+    assert(b.x != a.x || b.y != a.y);
+    std::memset(hits, 0, (items.size + 63) / 64 * sizeof(uint64_t));
+    const Move move{a, b, width};
+
+    switch (kernel) {
+        case BatchKernel::Scalar:
+            CollectScalar(move, items, 0, sq_distance, proj_ratio, hits);
+            return;
+        case BatchKernel::Avx2:
+#ifdef COLLISION_BATCH_X86
+            if (DetectBatchKernel() == BatchKernel::Avx2) {
+                CollectAvx2(move, items, sq_distance, proj_ratio, hits);
+                return;
+            }
+#endif
+            throw std::invalid_argument("AVX2 is not supported by this CPU");
+    }
+}
+
+}  // namespace collision_detector
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "geom.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace collision_detector {
+
+// Предметы, координаты и ширины которых лежат подряд в отдельных массивах
+struct ItemSpan {
+    const double* x;
+    const double* y;
+    const double* width;
+    size_t size;
+};
+
+enum class BatchKernel {
+    Scalar,
+    Avx2,
+};
+
+// Самая быстрая реализация, которую поддерживает процессор
+BatchKernel DetectBatchKernel() noexcept;
+
+// Проверяет ход собирателя шириной width из a в b против всех предметов items.
+// sq_distance[i] и proj_ratio[i] побитово совпадают с TryCollectPoint(a, b, {x[i], y[i]}),
+// бит i маски hits ((items.size + 63) / 64 слов) установлен, если предмет собран,
+// то есть CollectionResult::IsCollected(width + items.width[i]).
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, double width, const ItemSpan& items,
+                      double* sq_distance, double* proj_ratio, uint64_t* hits);
+
+// То же с явно выбранной реализацией, для тестов и замеров. Kernel должен поддерживаться.
+void TryCollectPoints(BatchKernel kernel, geom::Point2D a, geom::Point2D b, double width,
+                      const ItemSpan& items, double* sq_distance, double* proj_ratio,
+                      uint64_t* hits);
+
+}  // namespace collision_detector
@@ -1,5 +1,14 @@
 #include "collision_detector.h"
+#include "collision_batch.h"
+
+#include <bit>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 
 namespace collision_detector {
 
@@ -22,11 +31,455 @@ CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D
     return CollectionResult(sq_distance, proj_ratio);
 }
 
-// В задании на разработку тестов реализовывать следующую функцию не нужно -
-// она будет линковаться извне.
-/*
+namespace {
+
+// Число собирателей на поток, при котором запуск ещё одного потока окупается
+constexpr size_t kGatherersPerThread = 512;
+
+// Строку короче этого проверить по одному предмету дешевле, чем готовить пакет.
+// Результаты обоих способов совпадают побитово.
+constexpr size_t kMinBatchSize = 8;
+
+// sq_distance считается с погрешностью, поэтому область поиска берётся чуть шире радиуса
+// сбора, чтобы не потерять пару, которую засчитал бы полный перебор
+constexpr double kReachSlack = 1e-6;
+
+struct Box {
+    double min_x, min_y, max_x, max_y;
+};
+
+bool IsFinite(const Item& item) {
+    return std::isfinite(item.position.x) && std::isfinite(item.position.y)
+        && std::isfinite(item.width);
+}
+
+// Предметы, разложенные по ячейкам равномерной сетки. Координаты и ширины хранятся
+// отдельными массивами в порядке ячеек: предметы ячейки cell занимают позиции
+// [cell_start_[cell], cell_start_[cell + 1]), а соседние по x ячейки идут подряд,
+// поэтому строка ячеек проверяется одним пакетом.
+class ItemGrid {
+public:
+    // Ячейка не меньше min_cell, чтобы короткий ход собирателя задевал немного ячеек
+    ItemGrid(const std::vector<Item>& items, double min_cell) {
+        Box bounds{items.front().position.x, items.front().position.y,
+                   items.front().position.x, items.front().position.y};
+        for (const Item& item : items) {
+            bounds.min_x = std::min(bounds.min_x, item.position.x);
+            bounds.min_y = std::min(bounds.min_y, item.position.y);
+            bounds.max_x = std::max(bounds.max_x, item.position.x);
+            bounds.max_y = std::max(bounds.max_y, item.position.y);
+        }
+        origin_x_ = bounds.min_x;
+        origin_y_ = bounds.min_y;
+
+        // В среднем по предмету на ячейку, но ячеек не больше 3 * items.size() + 1,
+        // даже если предметы лежат на одной линии
+        const double width = bounds.max_x - bounds.min_x;
+        const double height = bounds.max_y - bounds.min_y;
+        const double count = static_cast<double>(items.size());
+        cell_ = std::max({std::sqrt(width * height / count), std::max(width, height) / count,
+                          min_cell, 1e-9});
+        // Разброс координат может не уместиться в double, тогда cell_ - inf или NaN,
+        // и все предметы попадают в одну ячейку
+        nx_ = ToCell(width, cell_, items.size() + 1) + 1;
+        ny_ = ToCell(height, cell_, items.size() + 1) + 1;
+
+        std::vector<size_t> item_cell(items.size());
+        cell_start_.assign(nx_ * ny_ + 1, 0);
+        for (size_t i = 0; i < items.size(); ++i) {
+            item_cell[i] = CellX(items[i].position.x) + CellY(items[i].position.y) * nx_;
+            ++cell_start_[item_cell[i] + 1];
+        }
+        for (size_t cell = 0; cell < nx_ * ny_; ++cell) {
+            cell_start_[cell + 1] += cell_start_[cell];
+        }
+
+        id_.resize(items.size());
+        std::vector<size_t> fill(cell_start_.begin(), cell_start_.end() - 1);
+        for (size_t i = 0; i < items.size(); ++i) {
+            id_[fill[item_cell[i]]++] = i;
+        }
+
+        // Запись по порядку позиций: каждый предмет читается одним обращением к памяти
+        x_.resize(items.size());
+        y_.resize(items.size());
+        width_.resize(items.size());
+        for (size_t pos = 0; pos < items.size(); ++pos) {
+            const Item& item = items[id_[pos]];
+            x_[pos] = item.position.x;
+            y_[pos] = item.position.y;
+            width_[pos] = item.width;
+        }
+    }
+
+    size_t Size() const {
+        return id_.size();
+    }
+
+    ItemSpan Items(size_t first, size_t last) const {
+        return {x_.data() + first, y_.data() + first, width_.data() + first, last - first};
+    }
+
+    const size_t* Ids() const {
+        return id_.data();
+    }
+
+    size_t CellsCount(const Box& box) const {
+        return (CellX(box.max_x) - CellX(box.min_x) + 1)
+             * (CellY(box.max_y) - CellY(box.min_y) + 1);
+    }
+
+    // Вызывает fn(first, last) для предметов каждой строки ячеек, которые задевает box
+    template <typename Fn>
+    void ForEachRow(const Box& box, Fn&& fn) const {
+        const size_t x0 = CellX(box.min_x), x1 = CellX(box.max_x);
+        const size_t y0 = CellY(box.min_y), y1 = CellY(box.max_y);
+        for (size_t y = y0; y <= y1; ++y) {
+            const size_t first = cell_start_[x0 + y * nx_];
+            const size_t last = cell_start_[x1 + y * nx_ + 1];
+            if (first != last) {
+                fn(first, last);
+            }
+        }
+    }
+
+private:
+    // Преобразование в size_t вне его диапазона - неопределённое поведение, поэтому индекс
+    // ограничивается до него. Сравнение отсекает и NaN.
+    static size_t ToCell(double offset, double cell, size_t count) {
+        const double index = offset / cell;
+        if (!(index > 0)) {
+            return 0;
+        }
+        if (index >= static_cast<double>(count - 1)) {
+            return count - 1;
+        }
+        return static_cast<size_t>(index);
+    }
+
+    size_t CellX(double x) const { return ToCell(x - origin_x_, cell_, nx_); }
+    size_t CellY(double y) const { return ToCell(y - origin_y_, cell_, ny_); }
+
+    double origin_x_ = 0;
+    double origin_y_ = 0;
+    double cell_ = 1;
+    size_t nx_ = 1;
+    size_t ny_ = 1;
+    std::vector<size_t> cell_start_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> width_;
+    std::vector<size_t> id_;
+};
+
+// Объект, а не функция, чтобы std::sort мог встроить сравнение
+struct EventBefore {
+    bool operator()(const GatheringEvent& lhs, const GatheringEvent& rhs) const {
+        return std::tie(lhs.time, lhs.gatherer_id, lhs.item_id)
+             < std::tie(rhs.time, rhs.gatherer_id, rhs.item_id);
+    }
+};
+
+Box GathererBox(const Gatherer& gatherer, double max_item_width) {
+    const double reach = (gatherer.width + max_item_width) * (1 + kReachSlack) + kReachSlack;
+    return {std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach,
+            std::min(gatherer.start_pos.y, gatherer.end_pos.y) - reach,
+            std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach,
+            std::max(gatherer.start_pos.y, gatherer.end_pos.y) + reach};
+}
+
+// Узкая фаза: проверяет предметы, лежащие подряд, и дописывает события сбора.
+// Буферы пакетной проверки переиспользуются между вызовами.
+class RunCollector {
+public:
+    explicit RunCollector(std::vector<GatheringEvent>& events)
+        : events_(events) {
+    }
+
+    // ids[k] - идентификатор k-го предмета items для события
+    void Collect(const Gatherer& gatherer, size_t gatherer_id, const ItemSpan& items,
+                 const size_t* ids) {
+        if (items.size < kMinBatchSize) {
+            for (size_t k = 0; k < items.size; ++k) {
+                const auto result =
+                    TryCollectPoint(gatherer.start_pos, gatherer.end_pos, {items.x[k], items.y[k]});
+                if (result.IsCollected(gatherer.width + items.width[k])) {
+                    events_.push_back({ids[k], gatherer_id, result.sq_distance, result.proj_ratio});
+                }
+            }
+            return;
+        }
+
+        if (sq_distance_.size() < items.size) {
+            sq_distance_.resize(items.size);
+            proj_ratio_.resize(items.size);
+            hits_.resize((items.size + 63) / 64);
+        }
+        TryCollectPoints(gatherer.start_pos, gatherer.end_pos, gatherer.width, items,
+                         sq_distance_.data(), proj_ratio_.data(), hits_.data());
+
+        for (size_t word = 0; word < (items.size + 63) / 64; ++word) {
+            for (uint64_t bits = hits_[word]; bits != 0; bits &= bits - 1) {
+                const size_t k = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+                events_.push_back({ids[k], gatherer_id, sq_distance_[k], proj_ratio_[k]});
+            }
+        }
+    }
+
+private:
+    std::vector<GatheringEvent>& events_;
+    std::vector<double> sq_distance_;
+    std::vector<double> proj_ratio_;
+    std::vector<uint64_t> hits_;
+};
+
+// Делит собирателей [0, gatherers_count) между потоками. collect(first, last, events)
+// дописывает события собирателей [first, last); события каждого потока сортируются
+// и затем сливаются. При равном времени события упорядочены по собирателю и предмету,
+// поэтому результат не зависит от числа потоков.
+template <typename Collect>
+std::vector<GatheringEvent> CollectSorted(size_t gatherers_count, const Collect& collect) {
+    const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t thread_count = std::clamp<size_t>(gatherers_count / kGatherersPerThread, 1,
+                                                   hardware_threads);
+
+    std::vector<std::vector<GatheringEvent>> parts(thread_count);
+    std::vector<std::exception_ptr> errors(thread_count);
+    auto process_part = [&](size_t part) {
+        try {
+            const size_t first = gatherers_count * part / thread_count;
+            const size_t last = gatherers_count * (part + 1) / thread_count;
+            collect(first, last, parts[part]);
+            std::sort(parts[part].begin(), parts[part].end(), EventBefore{});
+        } catch (...) {
+            errors[part] = std::current_exception();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(thread_count - 1);
+        for (size_t part = 1; part < thread_count; ++part) {
+            workers.emplace_back(process_part, part);
+        }
+        process_part(0);
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<GatheringEvent> events = std::move(parts.front());
+    for (size_t part = 1; part < thread_count; ++part) {
+        const auto middle = static_cast<std::ptrdiff_t>(events.size());
+        events.insert(events.end(), parts[part].begin(), parts[part].end());
+        std::inplace_merge(events.begin(), events.begin() + middle, events.end(), EventBefore{});
+    }
+    return events;
+}
+
+}  // namespace
+
+// Широкая фаза раскладывает предметы по равномерной сетке, и каждый собиратель проверяет
+// только предметы из ячеек, которые задевает его путь, расширенный на радиус сбора.
+// Узкая фаза проверяет предметы строки ячеек одним вызовом TryCollectPoints.
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+    std::vector<Item> items(provider.ItemsCount());
+    double max_item_width = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = provider.GetItem(i);
+        if (!IsFinite(items[i])) {
+            throw std::invalid_argument("Item coordinates and width must be finite");
+        }
+        max_item_width = std::max(max_item_width, items[i].width);
+    }
+
+    std::vector<Gatherer> gatherers(provider.GatherersCount());
+    double max_gatherer_width = 0;
+    for (size_t g = 0; g < gatherers.size(); ++g) {
+        gatherers[g] = provider.GetGatherer(g);
+        max_gatherer_width = std::max(max_gatherer_width, gatherers[g].width);
+    }
+
+    if (items.empty() || gatherers.empty()) {
+        return {};
+    }
+
+    const ItemGrid grid{items, max_item_width + max_gatherer_width};
+
+    return CollectSorted(gatherers.size(), [&](size_t first, size_t last,
+                                               std::vector<GatheringEvent>& events) {
+        RunCollector collector{events};
+        for (size_t g = first; g < last; ++g) {
+            const Gatherer& gatherer = gatherers[g];
+            if (gatherer.start_pos == gatherer.end_pos) {
+                continue;
+            }
+
+            auto collect_run = [&](size_t first_pos, size_t last_pos) {
+                collector.Collect(gatherer, g, grid.Items(first_pos, last_pos),
+                                  grid.Ids() + first_pos);
+            };
+
+            // Длинный диагональный ход накрывает больше ячеек, чем есть предметов
+            const Box box = GathererBox(gatherer, max_item_width);
+            if (grid.CellsCount(box) > grid.Size()) {
+                collect_run(0, grid.Size());
+            } else {
+                grid.ForEachRow(box, collect_run);
+            }
+        }
+    });
+}
+
+// CollisionWorld
+
+CollisionWorld::CollisionWorld(double cell_size)
+    : cell_size_(cell_size) {
+    if (!(cell_size > 0)) {
+        throw std::invalid_argument("Cell size must be positive");
+    }
+}
+
+size_t CollisionWorld::CellKeyHash::operator()(const CellKey& key) const noexcept {
+    // Финальное перемешивание splitmix64: соседние ячейки попадают в разные корзины
+    uint64_t h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ull
+               + static_cast<uint64_t>(key.y);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<size_t>(h ^ (h >> 31));
+}
+
+CollisionWorld::CellKey CollisionWorld::KeyOf(int64_t cell_x, int64_t cell_y) noexcept {
+    return {cell_x, cell_y};
+}
+
+int64_t CollisionWorld::CellOf(double coord) const noexcept {
+    // Преобразование в int64_t вне его диапазона - неопределённое поведение. Дальние
+    // координаты прижимаются к крайним ячейкам: порядок ячеек сохраняется, и поиск по
+    // прямоугольнику остаётся верным. NaN бывает только у собирателя и ничего не собирает.
+    constexpr double kMaxCell = 1ll << 52;
+    const double cell = std::floor(coord / cell_size_);
+    if (std::isnan(cell)) {
+        return 0;
+    }
+    return static_cast<int64_t>(std::clamp(cell, -kMaxCell, kMaxCell));
+}
+
+CollisionWorld::ItemId CollisionWorld::AddItem(Item item) {
+    if (!IsFinite(item)) {
+        throw std::invalid_argument("Item coordinates and width must be finite");
+    }
+
+    ItemId id;
+    if (free_ids_.empty()) {
+        id = locations_.size();
+        locations_.emplace_back();
+    } else {
+        id = free_ids_.back();
+        free_ids_.pop_back();
+    }
+
+    const CellKey key = KeyOf(CellOf(item.position.x), CellOf(item.position.y));
+    Cell& cell = cells_[key];
+    cell.x.push_back(item.position.x);
+    cell.y.push_back(item.position.y);
+    cell.width.push_back(item.width);
+    cell.ids.push_back(id);
+
+    locations_[id] = {key, cell.ids.size() - 1, true};
+    max_item_width_ = std::max(max_item_width_, item.width);
+    ++size_;
+    return id;
+}
+
+void CollisionWorld::RemoveItem(ItemId id) {
+    if (id >= locations_.size() || !locations_[id].alive) {
+        throw std::out_of_range("Unknown item id");
+    }
+    Location& location = locations_[id];
+    const auto cell_it = cells_.find(location.cell);
+    Cell& cell = cell_it->second;
+
+    // Последний предмет ячейки переезжает на место удаляемого
+    const size_t slot = location.slot;
+    const size_t last = cell.ids.size() - 1;
+    if (slot != last) {
+        cell.x[slot] = cell.x[last];
+        cell.y[slot] = cell.y[last];
+        cell.width[slot] = cell.width[last];
+        cell.ids[slot] = cell.ids[last];
+        locations_[cell.ids[slot]].slot = slot;
+    }
+    cell.x.pop_back();
+    cell.y.pop_back();
+    cell.width.pop_back();
+    cell.ids.pop_back();
+    if (cell.ids.empty()) {
+        cells_.erase(cell_it);
+    }
+
+    location.alive = false;
+    free_ids_.push_back(id);
+    --size_;
+}
+
+bool CollisionWorld::Contains(ItemId id) const noexcept {
+    return id < locations_.size() && locations_[id].alive;
+}
+
+Item CollisionWorld::GetItem(ItemId id) const {
+    if (!Contains(id)) {
+        throw std::out_of_range("Unknown item id");
+    }
+    const Location& location = locations_[id];
+    const Cell& cell = cells_.at(location.cell);
+    return {{cell.x[location.slot], cell.y[location.slot]}, cell.width[location.slot]};
+}
+
+std::vector<GatheringEvent> CollisionWorld::FindGatherEvents(
+    const std::vector<Gatherer>& gatherers) const {
+    if (size_ == 0 || gatherers.empty()) {
+        return {};
+    }
+
+    return CollectSorted(gatherers.size(), [&](size_t first, size_t last,
+                                               std::vector<GatheringEvent>& events) {
+        RunCollector collector{events};
+        for (size_t g = first; g < last; ++g) {
+            const Gatherer& gatherer = gatherers[g];
+            if (gatherer.start_pos == gatherer.end_pos) {
+                continue;
+            }
+
+            auto collect_cell = [&](const Cell& cell) {
+                const ItemSpan items{cell.x.data(), cell.y.data(), cell.width.data(),
+                                     cell.ids.size()};
+                collector.Collect(gatherer, g, items, cell.ids.data());
+            };
+
+            const Box box = GathererBox(gatherer, max_item_width_);
+            const int64_t x0 = CellOf(box.min_x), x1 = CellOf(box.max_x);
+            const int64_t y0 = CellOf(box.min_y), y1 = CellOf(box.max_y);
+
+            // Длинный ход накрывает больше ячеек, чем их занято предметами
+            if (static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1)
+                > static_cast<double>(cells_.size())) {
+                for (const auto& [key, cell] : cells_) {
+                    collect_cell(cell);
+                }
+                continue;
+            }
+            for (int64_t cell_x = x0; cell_x <= x1; ++cell_x) {
+                for (int64_t cell_y = y0; cell_y <= y1; ++cell_y) {
+                    if (const auto it = cells_.find(KeyOf(cell_x, cell_y)); it != cells_.end()) {
+                        collect_cell(it->second);
+                    }
+                }
+            }
+        }
+    });
 }
-*/
 
 }  // namespace collision_detector
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "geom.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace collision_detector {
@@ -52,8 +54,73 @@ struct GatheringEvent {
     double time;
 };
 
-// Эту функцию вам нужно будет реализовать в соответствующем задании.
-// При проверке ваших тестов она не нужна - функция будет линковаться снаружи.
+// События сбора в порядке времени. Собиратели, которые не сдвинулись, ничего не собирают.
+// При равном времени события упорядочены по gatherer_id, затем по item_id.
+// Координаты и ширина предметов должны быть конечными, иначе бросается std::invalid_argument.
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
+// Предметы, которые живут между тиками. Индекс меняется при появлении и сборе предметов,
+// а не строится заново на каждый ход, поэтому поиск событий стоит пропорционально числу
+// движущихся собирателей и предметов рядом с ними, а не всем предметам на карте.
+class CollisionWorld {
+public:
+    using ItemId = size_t;
+
+    // Ячейку стоит брать порядка пути собирателя за тик: короткий ход тогда задевает
+    // несколько ячеек, а пустые ячейки не хранятся
+    explicit CollisionWorld(double cell_size = 4.0);
+
+    // Идентификаторы удалённых предметов выдаются снова. Координаты и ширина должны быть
+    // конечными, иначе бросается std::invalid_argument
+    ItemId AddItem(Item item);
+    void RemoveItem(ItemId id);
+
+    bool Contains(ItemId id) const noexcept;
+    Item GetItem(ItemId id) const;
+    size_t ItemsCount() const noexcept {
+        return size_;
+    }
+
+    // События сбора, как в FindGatherEvents; item_id - идентификатор из AddItem.
+    // Предметы не удаляются: собранные вызывающий убирает сам через RemoveItem.
+    std::vector<GatheringEvent> FindGatherEvents(const std::vector<Gatherer>& gatherers) const;
+
+private:
+    struct CellKey {
+        int64_t x = 0;
+        int64_t y = 0;
+
+        bool operator==(const CellKey&) const = default;
+    };
+
+    struct CellKeyHash {
+        size_t operator()(const CellKey& key) const noexcept;
+    };
+
+    // Предметы ячейки отдельными массивами для пакетной проверки
+    struct Cell {
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> width;
+        std::vector<ItemId> ids;
+    };
+
+    struct Location {
+        CellKey cell;
+        size_t slot = 0;
+        bool alive = false;
+    };
+
+    static CellKey KeyOf(int64_t cell_x, int64_t cell_y) noexcept;
+    int64_t CellOf(double coord) const noexcept;
+
+    double cell_size_;
+    // Не уменьшается при удалении: поиск остаётся верным, лишь чуть шире
+    double max_item_width_ = 0;
+    size_t size_ = 0;
+    std::unordered_map<CellKey, Cell, CellKeyHash> cells_;
+    std::vector<Location> locations_;
+    std::vector<ItemId> free_ids_;
+};
+
 }  // namespace collision_detector
\ No newline at end of file
@@ -1,5 +1,383 @@
 #define _USE_MATH_DEFINES
 
+#include <bit>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+#include "../src/collision_batch.h"
 #include "../src/collision_detector.h"
 
-// Напишите здесь тесты для функции collision_detector::FindGatherEvents
\ No newline at end of file
+using namespace collision_detector;
+
+namespace {
+
+class Provider : public ItemGathererProvider {
+public:
+    Provider(std::vector<Item> items, std::vector<Gatherer> gatherers)
+        : items_(std::move(items))
+        , gatherers_(std::move(gatherers)) {
+    }
+
+    size_t ItemsCount() const override {
+        return items_.size();
+    }
+    Item GetItem(size_t idx) const override {
+        return items_.at(idx);
+    }
+    size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+    Gatherer GetGatherer(size_t idx) const override {
+        return gatherers_.at(idx);
+    }
+
+private:
+    std::vector<Item> items_;
+    std::vector<Gatherer> gatherers_;
+};
+
+// Полный перебор пар в том же порядке, что и FindGatherEvents
+std::vector<GatheringEvent> FindGatherEventsNaive(const ItemGathererProvider& provider) {
+    std::vector<GatheringEvent> events;
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        const Gatherer gatherer = provider.GetGatherer(g);
+        if (gatherer.start_pos == gatherer.end_pos) {
+            continue;
+        }
+        for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+            const Item item = provider.GetItem(i);
+            const auto result =
+                TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            if (result.IsCollected(gatherer.width + item.width)) {
+                events.push_back({i, g, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.time < rhs.time;
+    });
+    return events;
+}
+
+bool SameEvent(const GatheringEvent& lhs, const GatheringEvent& rhs) {
+    return std::tie(lhs.item_id, lhs.gatherer_id, lhs.sq_distance, lhs.time)
+        == std::tie(rhs.item_id, rhs.gatherer_id, rhs.sq_distance, rhs.time);
+}
+
+}  // namespace
+
+SCENARIO("Gather events without movement") {
+    GIVEN("items and a gatherer standing on one of them") {
+        const Provider provider{{{{0, 0}, 1.}, {{5, 0}, 1.}}, {{{0, 0}, {0, 0}, 1.}}};
+
+        THEN("nothing is gathered") {
+            CHECK(FindGatherEvents(provider).empty());
+        }
+    }
+
+    GIVEN("no items or no gatherers") {
+        THEN("there are no events") {
+            CHECK(FindGatherEvents(Provider{{}, {{{0, 0}, {10, 0}, 1.}}}).empty());
+            CHECK(FindGatherEvents(Provider{{{{1, 0}, 1.}}, {}}).empty());
+        }
+    }
+}
+
+SCENARIO("Gatherer moving along a road") {
+    GIVEN("a gatherer moving from (0, 0) to (10, 0) with width 0.6") {
+        const std::vector<Item> items{
+            {{7, 0.5}, 0.},    // собирается последним
+            {{2, -0.5}, 0.1},  // собирается первым
+            {{4, 1.}, 0.},     // дальше радиуса
+            {{4, 1.}, 0.5},    // то же место, но шире
+            {{11, 0}, 0.},     // за концом отрезка
+            {{-0.1, 0}, 0.},   // до начала отрезка
+        };
+        const Provider provider{items, {{{0, 0}, {10, 0}, 0.6}}};
+
+        WHEN("gather events are found") {
+            const auto events = FindGatherEvents(provider);
+
+            THEN("items within reach are gathered in order of time") {
+                REQUIRE(events.size() == 3);
+                CHECK(events[0].item_id == 1);
+                CHECK(events[0].time == 0.2);
+                CHECK(events[1].item_id == 3);
+                CHECK(events[1].time == 0.4);
+                CHECK(events[1].sq_distance == 1.);
+                CHECK(events[2].item_id == 0);
+                CHECK(events[2].time == 0.7);
+                CHECK(events[2].sq_distance == 0.25);
+                for (const auto& event : events) {
+                    CHECK(event.gatherer_id == 0);
+                }
+            }
+        }
+    }
+
+    GIVEN("two gatherers reaching items at the same time") {
+        const Provider provider{{{{5, 0}, 0.}, {{5, 1}, 0.}},
+                                {{{0, 1}, {10, 1}, 1.}, {{0, 0}, {10, 0}, 1.}}};
+
+        THEN("events are ordered by gatherer and then by item") {
+            const auto events = FindGatherEvents(provider);
+            REQUIRE(events.size() == 4);
+            CHECK(std::tie(events[0].gatherer_id, events[0].item_id) == std::tuple{0u, 0u});
+            CHECK(std::tie(events[1].gatherer_id, events[1].item_id) == std::tuple{0u, 1u});
+            CHECK(std::tie(events[2].gatherer_id, events[2].item_id) == std::tuple{1u, 0u});
+            CHECK(std::tie(events[3].gatherer_id, events[3].item_id) == std::tuple{1u, 1u});
+        }
+    }
+}
+
+SCENARIO("Gather events match exhaustive search") {
+    GIVEN("random items and gatherers, including long diagonal moves") {
+        std::mt19937 gen{42};
+        std::uniform_real_distribution<double> coord{0., 200.};
+        std::uniform_real_distribution<double> step{-3., 3.};
+        std::uniform_real_distribution<double> width{0., 1.};
+
+        std::vector<Item> items;
+        for (int i = 0; i < 3000; ++i) {
+            items.push_back({{coord(gen), coord(gen)}, width(gen) / 2});
+        }
+        // Предметы в одной точке и на одной линии
+        for (int i = 0; i < 50; ++i) {
+            items.push_back({{100., 100.}, 0.});
+            items.push_back({{static_cast<double>(i), 50.}, 0.});
+        }
+
+        std::vector<Gatherer> gatherers;
+        for (int g = 0; g < 2000; ++g) {
+            const geom::Point2D start{coord(gen), coord(gen)};
+            gatherers.push_back({start, {start.x + step(gen), start.y + step(gen)}, width(gen)});
+        }
+        for (int g = 0; g < 20; ++g) {
+            gatherers.push_back({{coord(gen), coord(gen)}, {coord(gen), coord(gen)}, width(gen)});
+        }
+        gatherers.push_back({{0, 50}, {100, 50}, 0.});
+        gatherers.push_back({{100, 100}, {100, 100}, 1.});
+
+        const Provider provider{std::move(items), std::move(gatherers)};
+
+        THEN("the same events are found in the same order") {
+            const auto events = FindGatherEvents(provider);
+            const auto expected = FindGatherEventsNaive(provider);
+            CHECK(events.size() > 100);
+            CHECK(std::equal(events.begin(), events.end(), expected.begin(), expected.end(),
+                             SameEvent));
+        }
+    }
+
+    GIVEN("a gatherer far from the items") {
+        // Номер ячейки собирателя не помещается в size_t
+        const Provider provider{{{{0, 0}, 0.}, {{1, 0}, 0.}, {{0, 1}, 0.}},
+                                {{{1e30, 0}, {1e30 + 1e15, 0}, 0.6}, {{-1, 0}, {2, 0}, 0.6}}};
+
+        THEN("the same events are found as by exhaustive search") {
+            const auto events = FindGatherEvents(provider);
+            const auto expected = FindGatherEventsNaive(provider);
+            REQUIRE(events.size() == 2);
+            CHECK(std::equal(events.begin(), events.end(), expected.begin(), expected.end(),
+                             SameEvent));
+        }
+    }
+
+    GIVEN("items spread wider than a double can measure") {
+        const Provider provider{{{{-1e308, 0}, 0.}, {{0, 0}, 0.}, {{1e308, 0}, 0.}},
+                                {{{-1, 0}, {1, 0}, 0.6}, {{1e308, -1}, {1e308, 1}, 0.6}}};
+
+        THEN("every item is still reachable") {
+            const auto events = FindGatherEvents(provider);
+            REQUIRE(events.size() == 2);
+            CHECK(std::tie(events[0].gatherer_id, events[0].item_id) == std::tuple{0u, 1u});
+            CHECK(std::tie(events[1].gatherer_id, events[1].item_id) == std::tuple{1u, 2u});
+        }
+    }
+
+    GIVEN("an item with non-finite coordinates") {
+        const Provider provider{{{{0, 0}, 0.}, {{NAN, 0}, 0.}}, {{{-1, 0}, {1, 0}, 0.6}}};
+
+        THEN("it is rejected") {
+            CHECK_THROWS_AS(FindGatherEvents(provider), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("Batch collection matches TryCollectPoint") {
+    GIVEN("items stored as separate arrays") {
+        std::mt19937 gen{7};
+        std::uniform_real_distribution<double> coord{-5., 5.};
+        std::uniform_real_distribution<double> width{0., 3.};
+
+        // 4 * 16 + 3 предмета, чтобы остался хвост после векторной части
+        const size_t count = 67;
+        std::vector<double> x(count), y(count), widths(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = coord(gen);
+            y[i] = coord(gen);
+            widths[i] = width(gen);
+        }
+        // Предмет в начале отрезка и предмет ровно на его продолжении
+        x[0] = 1.5, y[0] = -2.;
+        x[1] = 4.5, y[1] = 2.;
+
+        const geom::Point2D a{1.5, -2.}, b{3., 0.};
+        const double gatherer_width = 0.6;
+
+        std::vector<CollectionResult> expected;
+        for (size_t i = 0; i < count; ++i) {
+            expected.push_back(TryCollectPoint(a, b, {x[i], y[i]}));
+        }
+
+        std::vector<BatchKernel> kernels{BatchKernel::Scalar};
+        if (DetectBatchKernel() == BatchKernel::Avx2) {
+            kernels.push_back(BatchKernel::Avx2);
+        }
+
+        THEN("batch results are bitwise equal to the scalar function for every kernel") {
+            for (const BatchKernel kernel : kernels) {
+                std::vector<double> sq_distance(count), proj_ratio(count);
+                std::vector<uint64_t> hits((count + 63) / 64, ~uint64_t{0});
+                TryCollectPoints(kernel, a, b, gatherer_width,
+                                 {x.data(), y.data(), widths.data(), count}, sq_distance.data(),
+                                 proj_ratio.data(), hits.data());
+
+                size_t collected = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    INFO("kernel " << static_cast<int>(kernel) << ", item " << i);
+                    CHECK(std::bit_cast<uint64_t>(sq_distance[i])
+                          == std::bit_cast<uint64_t>(expected[i].sq_distance));
+                    CHECK(std::bit_cast<uint64_t>(proj_ratio[i])
+                          == std::bit_cast<uint64_t>(expected[i].proj_ratio));
+                    const bool hit = (hits[i / 64] >> (i % 64)) & 1;
+                    CHECK(hit == expected[i].IsCollected(gatherer_width + widths[i]));
+                    collected += hit;
+                }
+                CHECK(collected > 2);
+                CHECK(hits.back() >> (count % 64) == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Collision world keeps items between ticks") {
+    GIVEN("a world with a few items") {
+        CollisionWorld world{1.};
+        const auto near = world.AddItem({{2, 0.5}, 0.});
+        const auto far = world.AddItem({{2, 5.}, 0.});
+        const auto wide = world.AddItem({{-3.5, -1.}, 0.5});
+        const auto ahead = world.AddItem({{8, 0.}, 0.});
+        REQUIRE(world.ItemsCount() == 4);
+
+        const std::vector<Gatherer> gatherers{{{0, 0}, {10, 0}, 0.6}, {{-5, -1}, {-5, 1}, 1.}};
+
+        THEN("moves are checked against the stored items in order of time") {
+            const auto events = world.FindGatherEvents(gatherers);
+            REQUIRE(events.size() == 3);
+            CHECK(std::tie(events[0].gatherer_id, events[0].item_id) == std::tuple{1u, wide});
+            CHECK(std::tie(events[1].gatherer_id, events[1].item_id) == std::tuple{0u, near});
+            CHECK(std::tie(events[2].gatherer_id, events[2].item_id) == std::tuple{0u, ahead});
+        }
+
+        WHEN("a gathered item is removed") {
+            world.RemoveItem(near);
+
+            THEN("it is not gathered again and other ids stay valid") {
+                CHECK_FALSE(world.Contains(near));
+                CHECK(world.ItemsCount() == 3);
+                CHECK(world.GetItem(far).position == geom::Point2D{2, 5.});
+                const auto events = world.FindGatherEvents(gatherers);
+                REQUIRE(events.size() == 2);
+                CHECK(events[0].item_id == wide);
+                CHECK(events[1].item_id == ahead);
+                CHECK_THROWS_AS(world.RemoveItem(near), std::out_of_range);
+            }
+        }
+    }
+
+    GIVEN("items far from the origin") {
+        CollisionWorld world{1.};
+        const auto origin = world.AddItem({{0, 0}, 0.});
+        // Ячейки 0 и 2^32 совпали бы, если бы индекс ячейки обрезался до 32 бит
+        const auto far = world.AddItem({{4294967296., 0}, 0.});
+        const auto huge = world.AddItem({{1e18, 0}, 0.});
+
+        THEN("each is gathered only by the gatherer passing over it") {
+            const std::vector<Gatherer> gatherers{{{-1, 0}, {1, 0}, 0.5},
+                                                  {{4294967295., 0}, {4294967297., 0}, 0.5},
+                                                  {{1e18, -1e18}, {1e18, 1e18}, 0.5}};
+            const auto events = world.FindGatherEvents(gatherers);
+            REQUIRE(events.size() == 3);
+            CHECK(std::tie(events[0].gatherer_id, events[0].item_id) == std::tuple{0u, origin});
+            CHECK(std::tie(events[1].gatherer_id, events[1].item_id) == std::tuple{1u, far});
+            CHECK(std::tie(events[2].gatherer_id, events[2].item_id) == std::tuple{2u, huge});
+        }
+
+        THEN("non-finite coordinates are handled without undefined conversions") {
+            constexpr double inf = std::numeric_limits<double>::infinity();
+            CHECK_THROWS_AS(world.AddItem({{NAN, 0}, 0.}), std::invalid_argument);
+            CHECK_THROWS_AS(world.AddItem({{0, inf}, 0.}), std::invalid_argument);
+            CHECK_THROWS_AS(world.AddItem({{0, 0}, inf}), std::invalid_argument);
+            CHECK(world.ItemsCount() == 3);
+            CHECK(world.FindGatherEvents({{{NAN, 0}, {1, 0}, 0.5}}).empty());
+        }
+    }
+
+    GIVEN("items spawned and collected over many ticks") {
+        std::mt19937 gen{3};
+        std::uniform_real_distribution<double> coord{-50., 50.};
+        std::uniform_real_distribution<double> step{-4., 4.};
+        std::uniform_real_distribution<double> width{0., 0.5};
+
+        CollisionWorld world{2.};
+        // Живые предметы в порядке идентификаторов, чтобы сравнить с FindGatherEvents
+        std::vector<std::pair<CollisionWorld::ItemId, Item>> alive;
+
+        THEN("every tick matches a search over all live items") {
+            for (int tick = 0; tick < 20; ++tick) {
+                for (int i = 0; i < 200; ++i) {
+                    const Item item{{coord(gen), coord(gen)}, width(gen)};
+                    alive.emplace_back(world.AddItem(item), item);
+                }
+                std::vector<Gatherer> gatherers;
+                for (int g = 0; g < 100; ++g) {
+                    const geom::Point2D start{coord(gen), coord(gen)};
+                    gatherers.push_back({start, {start.x + step(gen), start.y}, 0.6});
+                }
+                gatherers.push_back({{-50, -50}, {50, 50}, 0.6});
+
+                std::sort(alive.begin(), alive.end(), [](const auto& lhs, const auto& rhs) {
+                    return lhs.first < rhs.first;
+                });
+                std::vector<Item> items;
+                for (const auto& [id, item] : alive) {
+                    items.push_back(item);
+                }
+                auto expected = FindGatherEvents(Provider{items, gatherers});
+                for (auto& event : expected) {
+                    event.item_id = alive[event.item_id].first;
+                }
+
+                const auto events = world.FindGatherEvents(gatherers);
+                REQUIRE(events.size() == expected.size());
+                CHECK(std::equal(events.begin(), events.end(), expected.begin(), SameEvent));
+
+                // Собранные предметы исчезают, как в игре
+                for (const auto& event : events) {
+                    if (world.Contains(event.item_id)) {
+                        world.RemoveItem(event.item_id);
+                    }
+                }
+                std::erase_if(alive, [&](const auto& entry) {
+                    return !world.Contains(entry.first);
+                });
+                REQUIRE(world.ItemsCount() == alive.size());
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "action_log.h"
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <boost/crc.hpp>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "binary_io.h"
+
+namespace serialization {
+
+namespace {
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+// Запись: размер полезной нагрузки u32, её CRC-32 u32, нагрузка.
+// Нагрузка: номер записи u64, тип события u8, поля события.
+constexpr size_t RECORD_HEADER_SIZE = 8;
+
+constexpr std::string_view SEGMENT_PREFIX = "actions-"sv;
+constexpr std::string_view SEGMENT_SUFFIX = ".log"sv;
+
+enum class EventType : uint8_t {
+    JOIN = 1,
+    ACTION = 2,
+    TICK = 3,
+};
+
+// Остановка собаки в ActionEvent
+constexpr uint8_t NO_DIRECTION = 0xFF;
+
+uint32_t Checksum(std::string_view data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+class EventEncoder {
+public:
+    explicit EventEncoder(BinaryWriter& writer)
+        : writer_(writer) {
+    }
+
+    void operator()(const JoinEvent& event) {
+        writer_.Uint(static_cast<uint8_t>(EventType::JOIN));
+        writer_.Uint(*event.dog_id);
+        writer_.String(event.dog_name);
+        writer_.String(event.map_id);
+    }
+
+    void operator()(const ActionEvent& event) {
+        writer_.Uint(static_cast<uint8_t>(EventType::ACTION));
+        writer_.Uint(*event.dog_id);
+        writer_.Uint(event.direction ? static_cast<uint8_t>(*event.direction) : NO_DIRECTION);
+    }
+
+    void operator()(const TickEvent& event) {
+        writer_.Uint(static_cast<uint8_t>(EventType::TICK));
+        writer_.Uint(static_cast<uint64_t>(event.time_delta.count()));
+    }
+
+private:
+    BinaryWriter& writer_;
+};
+
+LogEvent DecodeEvent(BinaryReader& reader) {
+    switch (static_cast<EventType>(reader.Uint<uint8_t>())) {
+        case EventType::JOIN: {
+            JoinEvent event;
+            event.dog_id = model::Dog::Id{reader.Uint<uint32_t>()};
+            event.dog_name = reader.String();
+            event.map_id = reader.String();
+            return event;
+        }
+        case EventType::ACTION: {
+            ActionEvent event;
+            event.dog_id = model::Dog::Id{reader.Uint<uint32_t>()};
+            if (const auto direction = reader.Uint<uint8_t>(); direction != NO_DIRECTION) {
+                if (direction > static_cast<uint8_t>(model::Direction::SOUTH)) {
+                    throw std::runtime_error("Invalid direction in action log");
+                }
+                event.direction = static_cast<model::Direction>(direction);
+            }
+            return event;
+        }
+        case EventType::TICK:
+            return TickEvent{std::chrono::milliseconds{
+                static_cast<std::chrono::milliseconds::rep>(reader.Uint<uint64_t>())}};
+    }
+    throw std::runtime_error("Unknown event type in action log");
+}
+
+fs::path SegmentPath(const fs::path& dir, uint64_t first_position) {
+    // Номер дополнен нулями, чтобы сегменты в каталоге шли по порядку
+    auto name = std::to_string(first_position);
+    name.insert(0, 20 - std::min<size_t>(name.size(), 20), '0');
+    return dir / (std::string{SEGMENT_PREFIX} + name + std::string{SEGMENT_SUFFIX});
+}
+
+struct Segment {
+    uint64_t first_position;
+    fs::path path;
+};
+
+// Сегменты журнала в каталоге по возрастанию номера первой записи
+std::vector<Segment> ListSegments(const fs::path& dir) {
+    std::vector<Segment> segments;
+    if (!fs::exists(dir)) {
+        return segments;
+    }
+    for (const auto& entry : fs::directory_iterator{dir}) {
+        const auto name = entry.path().filename().string();
+        if (!entry.is_regular_file() || !name.starts_with(SEGMENT_PREFIX)
+            || !name.ends_with(SEGMENT_SUFFIX)) {
+            continue;
+        }
+        const auto number = std::string_view{name}.substr(
+            SEGMENT_PREFIX.size(), name.size() - SEGMENT_PREFIX.size() - SEGMENT_SUFFIX.size());
+        uint64_t first_position = 0;
+        const auto [end, ec] =
+            std::from_chars(number.data(), number.data() + number.size(), first_position);
+        if (ec == std::errc{} && end == number.data() + number.size()) {
+            segments.push_back({first_position, entry.path()});
+        }
+    }
+    std::sort(segments.begin(), segments.end(), [](const Segment& lhs, const Segment& rhs) {
+        return lhs.first_position < rhs.first_position;
+    });
+    return segments;
+}
+
+std::string ReadFile(const fs::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        throw std::runtime_error("Failed to open "s + path.string());
+    }
+    std::string data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    if (file.bad()) {
+        throw std::runtime_error("Failed to read "s + path.string());
+    }
+    return data;
+}
+
+}  // namespace
+
+ActionLog::ActionLog(fs::path dir, uint64_t next_position, size_t segment_size)
+    : dir_(std::move(dir))
+    , segment_size_(segment_size)
+    , buffer_first_position_(next_position)
+    , last_position_(next_position - 1)
+    , durable_position_(next_position - 1) {
+    if (next_position == 0) {
+        throw std::invalid_argument("Action log positions start from 1");
+    }
+    fs::create_directories(dir_);
+    // Сегменты с номерами от next_position остались от запуска, журнал которого при
+    // восстановлении оборвался раньше. Их записи недействительны: при следующем
+    // восстановлении они продолжили бы новые записи с теми же номерами.
+    bool removed = false;
+    for (const auto& segment : ListSegments(dir_)) {
+        if (segment.first_position >= next_position) {
+            fs::remove(segment.path);
+            removed = true;
+        }
+    }
+    if (removed) {
+        SyncDirectory(dir_);
+    }
+    OpenSegment(next_position);
+    worker_ = std::jthread{[this](std::stop_token stop) {
+        Run(stop);
+    }};
+}
+
+ActionLog::~ActionLog() {
+    worker_.request_stop();
+    worker_.join();
+}
+
+uint64_t ActionLog::Append(const LogEvent& event) {
+    std::lock_guard lock{mutex_};
+
+    // Заголовок заполняется после кодирования, когда известны размер и контрольная сумма
+    const size_t header = buffer_.size();
+    buffer_.append(RECORD_HEADER_SIZE, '\0');
+
+    const uint64_t position = last_position_ + 1;
+    BinaryWriter writer{buffer_};
+    writer.Uint(position);
+    std::visit(EventEncoder{writer}, event);
+
+    const std::string_view payload = std::string_view{buffer_}.substr(header + RECORD_HEADER_SIZE);
+    std::string record_header;
+    BinaryWriter header_writer{record_header};
+    header_writer.Uint(static_cast<uint32_t>(payload.size()));
+    header_writer.Uint(Checksum(payload));
+    buffer_.replace(header, RECORD_HEADER_SIZE, record_header);
+
+    last_position_ = position;
+    cv_.notify_all();
+    return position;
+}
+
+uint64_t ActionLog::GetLastPosition() const {
+    std::lock_guard lock{mutex_};
+    return last_position_;
+}
+
+void ActionLog::WaitDurable(uint64_t position) {
+    std::unique_lock lock{mutex_};
+    cv_.wait(lock, [this, position] {
+        return durable_position_ >= position || error_;
+    });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void ActionLog::RemoveUpTo(uint64_t position) {
+    // Последний сегмент не удаляется никогда: в него может писать фоновый поток
+    const auto segments = ListSegments(dir_);
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        if (segments[i + 1].first_position > position + 1) {
+            break;
+        }
+        fs::remove(segments[i].path);
+    }
+}
+
+void ActionLog::OpenSegment(uint64_t first_position) {
+    if (segment_) {
+        segment_.Close();
+    }
+    segment_ = FileDescriptor::Open(SegmentPath(dir_, first_position),
+                                    O_WRONLY | O_CREAT | O_TRUNC | O_APPEND);
+    SyncDirectory(dir_);
+    segment_written_ = 0;
+}
+
+void ActionLog::Run(std::stop_token stop) {
+    std::string batch;
+
+    while (true) {
+        uint64_t first_position = 0;
+        uint64_t last_position = 0;
+        bool failed = false;
+        {
+            std::unique_lock lock{mutex_};
+            // После запроса остановки оставшиеся в буфере события всё равно будут записаны
+            if (!cv_.wait(lock, stop, [this] {
+                    return !buffer_.empty();
+                })) {
+                return;
+            }
+            batch.clear();
+            std::swap(batch, buffer_);
+            first_position = buffer_first_position_;
+            last_position = last_position_;
+            buffer_first_position_ = last_position + 1;
+            failed = static_cast<bool>(error_);
+        }
+
+        // После ошибки в сегменте может остаться часть пакета, и дописывать за ней нельзя:
+        // при восстановлении всё после повреждённой записи будет отброшено
+        if (failed) {
+            continue;
+        }
+
+        std::exception_ptr error;
+        try {
+            if (segment_written_ >= segment_size_) {
+                OpenSegment(first_position);
+            }
+            segment_.WriteAll(batch);
+            segment_written_ += batch.size();
+            segment_.Sync(true);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            if (error) {
+                error_ = error;
+            } else {
+                durable_position_ = last_position;
+            }
+        }
+        cv_.notify_all();
+    }
+}
+
+ReplayResult ReplayActionLog(const fs::path& dir, uint64_t after_position,
+                             const std::function<void(uint64_t, const LogEvent&)>& handler) {
+    ReplayResult result{after_position, false};
+    const auto segments = ListSegments(dir);
+    // Номер, с которого должен начинаться следующий сегмент, когда чтение уже началось
+    std::optional<uint64_t> chain_position;
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+        // Все записи сегмента уже учтены, если следующий начинается не позже нужной записи
+        if (!chain_position && i + 1 < segments.size()
+            && segments[i + 1].first_position <= result.last_position + 1) {
+            continue;
+        }
+        // Пропуск в нумерации означает, что записи между сегментами потеряны. Сегмент,
+        // начинающийся раньше, чем закончился прочитанный, не продолжает его.
+        if (chain_position ? segments[i].first_position != *chain_position
+                           : segments[i].first_position > result.last_position + 1) {
+            result.damaged = true;
+            break;
+        }
+
+        const std::string data = ReadFile(segments[i].path);
+        std::string_view rest = data;
+        uint64_t expected = segments[i].first_position;
+        result.damaged = false;
+
+        while (!rest.empty()) {
+            // Оборванную или испорченную запись оставляет сбой посреди записи пакета.
+            // Следующий сегмент, если он есть, продолжает журнал с первой потерянной записи.
+            std::optional<std::pair<uint64_t, LogEvent>> record;
+            try {
+                BinaryReader header{rest.substr(0, RECORD_HEADER_SIZE)};
+                const auto size = header.Uint<uint32_t>();
+                const auto checksum = header.Uint<uint32_t>();
+                if (rest.size() - RECORD_HEADER_SIZE < size) {
+                    throw std::runtime_error("Record is truncated");
+                }
+                const auto payload = rest.substr(RECORD_HEADER_SIZE, size);
+                if (Checksum(payload) != checksum) {
+                    throw std::runtime_error("Record checksum mismatch");
+                }
+                BinaryReader reader{payload};
+                const auto position = reader.Uint<uint64_t>();
+                auto event = DecodeEvent(reader);
+                if (position != expected || !reader.AtEnd()) {
+                    throw std::runtime_error("Malformed record");
+                }
+                record.emplace(position, std::move(event));
+                rest.remove_prefix(RECORD_HEADER_SIZE + size);
+            } catch (const std::runtime_error&) {
+                result.damaged = true;
+                break;
+            }
+
+            ++expected;
+            if (record->first > result.last_position) {
+                handler(record->first, record->second);
+                result.last_position = record->first;
+            }
+        }
+        chain_position = expected;
+    }
+    return result;
+}
+
+}  // namespace serialization
@@ -0,0 +1,125 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+
+#include "model.h"
+#include "posix_file.h"
+
+namespace serialization {
+
+// Игрок присоединился к игре на карте map_id
+struct JoinEvent {
+    model::Dog::Id dog_id{0u};
+    std::string dog_name;
+    std::string map_id;
+
+    auto operator<=>(const JoinEvent&) const = default;
+};
+
+// Игрок сменил направление движения собаки, nullopt - остановка
+struct ActionEvent {
+    model::Dog::Id dog_id{0u};
+    std::optional<model::Direction> direction;
+
+    auto operator<=>(const ActionEvent&) const = default;
+};
+
+// Игровое время продвинулось на time_delta
+struct TickEvent {
+    std::chrono::milliseconds time_delta{};
+
+    auto operator<=>(const TickEvent&) const = default;
+};
+
+using LogEvent = std::variant<JoinEvent, ActionEvent, TickEvent>;
+
+/*
+ * Журнал действий, изменяющих состояние игры (write-ahead log).
+ *
+ * Записи получают последовательные номера и дописываются в сегменты
+ * actions-<номер первой записи>.log в каталоге журнала. Append только кладёт
+ * запись в буфер, фоновый поток пишет накопленное одним write и одним fdatasync
+ * (group commit), поэтому частота fsync не зависит от числа событий.
+ *
+ * Восстановление после сбоя:
+ *   1. загрузить последний снимок, position = snapshot->GetLogPosition();
+ *   2. ReplayActionLog(dir, position, ...) применяет записи после снимка;
+ *   3. продолжить журнал: ActionLog log{dir, result.last_position + 1}.
+ * Снимок помечается номером последней применённой записи (SetLogPosition),
+ * а после его записи на диск RemoveUpTo удаляет ставшие ненужными сегменты.
+ */
+class ActionLog {
+public:
+    // Начинает новый сегмент, первая добавленная запись получит номер next_position (> 0).
+    // Сегменты, начинающиеся с next_position и дальше, удаляются.
+    ActionLog(std::filesystem::path dir, uint64_t next_position,
+              size_t segment_size = DEFAULT_SEGMENT_SIZE);
+
+    ActionLog(const ActionLog&) = delete;
+    ActionLog& operator=(const ActionLog&) = delete;
+
+    // Дожидается записи всех добавленных событий. Ошибки записи игнорируются.
+    ~ActionLog();
+
+    // Размер, после которого фоновый поток начинает новый сегмент
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+
+    // Добавляет событие и возвращает его номер. Не ждёт записи на диск.
+    uint64_t Append(const LogEvent& event);
+
+    // Номер последнего добавленного события, 0 - если событий не было
+    uint64_t GetLastPosition() const;
+
+    // Ждёт, пока событие с номером position окажется на диске.
+    // Бросает исключение, если запись журнала завершилась ошибкой.
+    void WaitDurable(uint64_t position);
+
+    // Удаляет сегменты, все записи которых имеют номера не больше position
+    void RemoveUpTo(uint64_t position);
+
+private:
+    void Run(std::stop_token stop);
+    void OpenSegment(uint64_t first_position);
+
+    std::filesystem::path dir_;
+    size_t segment_size_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any cv_;
+    std::string buffer_;
+    uint64_t buffer_first_position_;
+    uint64_t last_position_;
+    uint64_t durable_position_;
+    std::exception_ptr error_;
+
+    // Используются только фоновым потоком
+    FileDescriptor segment_;
+    size_t segment_written_ = 0;
+
+    // Объявлен последним: поток должен остановиться раньше, чем разрушатся данные выше
+    std::jthread worker_;
+};
+
+struct ReplayResult {
+    // Номер последней применённой записи, либо after_position, если таких не было
+    uint64_t last_position;
+    // Журнал оборван или повреждён: записи после last_position потеряны
+    bool damaged;
+};
+
+// Передаёт handler все записи журнала в каталоге dir с номерами больше after_position,
+// по возрастанию номеров. Останавливается на первой повреждённой записи, пропуске или
+// сегменте, который не продолжает прочитанные записи.
+ReplayResult ReplayActionLog(const std::filesystem::path& dir, uint64_t after_position,
+                             const std::function<void(uint64_t, const LogEvent&)>& handler);
+
+}  // namespace serialization
@@ -0,0 +1,91 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace serialization {
+
+// Запись чисел в little-endian, double - как биты IEEE 754
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& out)
+        : out_(out) {
+    }
+
+    void Bytes(std::string_view bytes) {
+        out_.append(bytes);
+    }
+
+    template <typename T>
+    void Uint(T value) {
+        char bytes[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        out_.append(bytes, sizeof(T));
+    }
+
+    void Double(double value) {
+        Uint(std::bit_cast<uint64_t>(value));
+    }
+
+    // Длина u32, затем байты строки
+    void String(std::string_view str) {
+        if (str.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("String is too long");
+        }
+        Uint(static_cast<uint32_t>(str.size()));
+        Bytes(str);
+    }
+
+private:
+    std::string& out_;
+};
+
+// Чтение данных BinaryWriter. Бросает std::runtime_error, если данных не хватает.
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data)
+        : data_(data) {
+    }
+
+    std::string_view Bytes(size_t size) {
+        if (data_.size() - pos_ < size) {
+            throw std::runtime_error("Data is truncated");
+        }
+        auto bytes = data_.substr(pos_, size);
+        pos_ += size;
+        return bytes;
+    }
+
+    template <typename T>
+    T Uint() {
+        const auto bytes = Bytes(sizeof(T));
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<T>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    double Double() {
+        return std::bit_cast<double>(Uint<uint64_t>());
+    }
+
+    std::string_view String() {
+        return Bytes(Uint<uint32_t>());
+    }
+
+    bool AtEnd() const noexcept {
+        return pos_ == data_.size();
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+}  // namespace serialization
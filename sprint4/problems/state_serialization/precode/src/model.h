@@ -57,7 +57,7 @@ public:
         return id_;
     }
 
-    const std::string GetName() const noexcept {
+    const std::string& GetName() const noexcept {
         return name_;
     }
 
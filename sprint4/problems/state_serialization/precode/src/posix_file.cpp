@@ -0,0 +1,78 @@
+#include "posix_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+namespace serialization {
+
+using namespace std::literals;
+
+void ThrowErrno(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+FileDescriptor::FileDescriptor(FileDescriptor&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)) {
+}
+
+FileDescriptor& FileDescriptor::operator=(FileDescriptor&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+FileDescriptor::~FileDescriptor() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+FileDescriptor FileDescriptor::Open(const std::filesystem::path& path, int flags, int mode) {
+    FileDescriptor file{::open(path.c_str(), flags | O_CLOEXEC, mode)};
+    if (!file) {
+        ThrowErrno("Failed to open "s + path.string());
+    }
+    return file;
+}
+
+void FileDescriptor::WriteAll(std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd_, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("write"s);
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void FileDescriptor::Sync(bool data_only) {
+    if ((data_only ? ::fdatasync(fd_) : ::fsync(fd_)) != 0) {
+        ThrowErrno("fsync"s);
+    }
+}
+
+void FileDescriptor::Close() {
+    const int fd = std::exchange(fd_, -1);
+    if (::close(fd) != 0) {
+        ThrowErrno("close"s);
+    }
+}
+
+void SyncDirectory(const std::filesystem::path& dir) {
+    auto dir_fd = FileDescriptor::Open(dir.empty() ? std::filesystem::path{"."} : dir,
+                                       O_RDONLY | O_DIRECTORY);
+    dir_fd.Sync();
+}
+
+}  // namespace serialization
@@ -0,0 +1,50 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace serialization {
+
+// Владеет файловым дескриптором POSIX
+class FileDescriptor {
+public:
+    FileDescriptor() = default;
+    explicit FileDescriptor(int fd) noexcept
+        : fd_(fd) {
+    }
+
+    FileDescriptor(FileDescriptor&& other) noexcept;
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept;
+
+    ~FileDescriptor();
+
+    // Открывает файл через ::open, бросает std::system_error при ошибке
+    static FileDescriptor Open(const std::filesystem::path& path, int flags, int mode = 0644);
+
+    int Get() const noexcept {
+        return fd_;
+    }
+
+    explicit operator bool() const noexcept {
+        return fd_ >= 0;
+    }
+
+    // Записывает data целиком, повторяя прерванные вызовы write
+    void WriteAll(std::string_view data);
+
+    // fsync, либо fdatasync, если метаданные файла сохранять не нужно
+    void Sync(bool data_only = false);
+
+    // close может сообщить об ошибке отложенной записи, поэтому её нужно проверить
+    void Close();
+
+private:
+    int fd_ = -1;
+};
+
+[[noreturn]] void ThrowErrno(const std::string& what);
+
+// fsync каталога: без него создание или переименование файла может потеряться при сбое питания
+void SyncDirectory(const std::filesystem::path& dir);
+
+}  // namespace serialization
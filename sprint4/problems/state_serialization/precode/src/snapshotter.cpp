@@ -0,0 +1,115 @@
+#include "snapshotter.h"
+
+#include <fcntl.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "posix_file.h"
+
+namespace serialization {
+
+using namespace std::literals;
+
+void WriteFileAtomically(const std::filesystem::path& path, std::string_view data) {
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    auto file = FileDescriptor::Open(temp_path, O_WRONLY | O_CREAT | O_TRUNC);
+    file.WriteAll(data);
+    file.Sync();
+    file.Close();
+
+    std::filesystem::rename(temp_path, path);
+    SyncDirectory(path.parent_path());
+}
+
+std::optional<GameStateSnapshot> LoadSnapshot(const std::filesystem::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        if (!std::filesystem::exists(path)) {
+            return std::nullopt;
+        }
+        throw std::runtime_error("Failed to open "s + path.string());
+    }
+    const std::string data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    if (file.bad()) {
+        throw std::runtime_error("Failed to read "s + path.string());
+    }
+    return GameStateSnapshot::Decode(data);
+}
+
+Snapshotter::Snapshotter(std::filesystem::path path)
+    : path_(std::move(path))
+    , worker_([this](std::stop_token stop) {
+        Run(stop);
+    }) {
+}
+
+Snapshotter::~Snapshotter() {
+    worker_.request_stop();
+    worker_.join();
+}
+
+void Snapshotter::Submit(GameStateSnapshot& snapshot) {
+    {
+        std::lock_guard lock{mutex_};
+        std::swap(pending_, snapshot);
+        has_pending_ = true;
+    }
+    cv_.notify_all();
+    // Вне блокировки: очистка векторов тривиальных записей не освобождает память
+    snapshot.Clear();
+}
+
+void Snapshotter::Flush() {
+    std::unique_lock lock{mutex_};
+    cv_.wait(lock, [this] {
+        return !has_pending_ && !writing_;
+    });
+    if (auto error = std::exchange(error_, nullptr)) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Snapshotter::Run(std::stop_token stop) {
+    GameStateSnapshot snapshot;
+    std::string buffer;
+
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            // После запроса остановки ожидание сразу вернёт has_pending_, так что
+            // последний переданный снимок всё равно будет записан
+            if (!cv_.wait(lock, stop, [this] {
+                    return has_pending_;
+                })) {
+                return;
+            }
+            std::swap(snapshot, pending_);
+            has_pending_ = false;
+            writing_ = true;
+        }
+
+        std::exception_ptr error;
+        try {
+            buffer.clear();
+            snapshot.Encode(buffer);
+            WriteFileAtomically(path_, buffer);
+            saved_log_position_.store(snapshot.GetLogPosition(), std::memory_order_release);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            writing_ = false;
+            error_ = error;
+        }
+        cv_.notify_all();
+    }
+}
+
+}  // namespace serialization
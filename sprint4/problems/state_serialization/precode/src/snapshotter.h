@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "state_snapshot.h"
+
+namespace serialization {
+
+// Записывает data во временный файл рядом с path, делает fsync и переименовывает его в path.
+// После сбоя на диске остаётся либо прежний файл, либо новый целиком.
+void WriteFileAtomically(const std::filesystem::path& path, std::string_view data);
+
+// Читает снимок, сохранённый Snapshotter. Возвращает nullopt, если файла нет.
+std::optional<GameStateSnapshot> LoadSnapshot(const std::filesystem::path& path);
+
+/*
+ * Фоновое сохранение состояния игры.
+ * Поток тика заполняет GameStateSnapshot и передаёт его в Submit за O(1).
+ * Кодирование и запись на диск выполняются в отдельном потоке.
+ * Если запись не успевает за Submit, промежуточные снимки пропускаются:
+ * на диск попадает последний переданный.
+ */
+class Snapshotter {
+public:
+    explicit Snapshotter(std::filesystem::path path);
+
+    Snapshotter(const Snapshotter&) = delete;
+    Snapshotter& operator=(const Snapshotter&) = delete;
+
+    // Дожидается записи последнего переданного снимка. Ошибки записи игнорируются.
+    ~Snapshotter();
+
+    // Забирает содержимое snapshot. Взамен snapshot получает очищенный буфер одного из
+    // прошлых снимков, чтобы следующий захват не выделял память.
+    void Submit(GameStateSnapshot& snapshot);
+
+    // Ждёт, пока будут записаны все переданные снимки.
+    // Бросает исключение, если последняя запись завершилась ошибкой.
+    void Flush();
+
+    // Позиция журнала действий из последнего снимка, успешно записанного на диск.
+    // Записи журнала до неё включительно больше не нужны для восстановления.
+    uint64_t GetSavedLogPosition() const noexcept {
+        return saved_log_position_.load(std::memory_order_acquire);
+    }
+
+private:
+    void Run(std::stop_token stop);
+
+    std::filesystem::path path_;
+
+    std::mutex mutex_;
+    std::condition_variable_any cv_;
+    GameStateSnapshot pending_;
+    bool has_pending_ = false;
+    bool writing_ = false;
+    std::exception_ptr error_;
+    std::atomic<uint64_t> saved_log_position_{0};
+
+    // Объявлен последним: поток должен остановиться раньше, чем разрушатся данные выше
+    std::jthread worker_;
+};
+
+}  // namespace serialization
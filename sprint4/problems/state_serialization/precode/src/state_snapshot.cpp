@@ -0,0 +1,162 @@
+#include "state_snapshot.h"
+
+#include <limits>
+#include <stdexcept>
+
+#include "binary_io.h"
+
+namespace serialization {
+
+namespace {
+
+using namespace std::literals;
+
+// Формат: "DSNP", версия u32, тик u64, позиция в журнале действий u64 (с версии 2),
+// число собак u64, затем собаки
+constexpr std::string_view MAGIC = "DSNP"sv;
+constexpr uint32_t FIRST_LOG_POSITION_VERSION = 2;
+
+// Dog сразу резервирует память под весь рюкзак, поэтому вместимость из файла ограничена
+constexpr uint64_t MAX_BAG_CAPACITY = 1 << 20;
+
+model::Direction DirectionFromByte(uint8_t value) {
+    switch (static_cast<model::Direction>(value)) {
+        case model::Direction::NORTH:
+        case model::Direction::EAST:
+        case model::Direction::WEST:
+        case model::Direction::SOUTH:
+            return static_cast<model::Direction>(value);
+    }
+    throw std::runtime_error("Invalid dog direction in snapshot");
+}
+
+uint32_t CheckedSize(size_t size) {
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Snapshot is too large");
+    }
+    return static_cast<uint32_t>(size);
+}
+
+}  // namespace
+
+void GameStateSnapshot::AddDog(const model::Dog& dog) {
+    const auto& name = dog.GetName();
+    const auto& bag = dog.GetBagContent();
+    if (dog.GetBagCapacity() > MAX_BAG_CAPACITY) {
+        throw std::length_error("Bag capacity is too large for snapshot");
+    }
+
+    dogs_.push_back({*dog.GetId(), CheckedSize(names_.size()), CheckedSize(name.size()),
+                     CheckedSize(bags_.size()), CheckedSize(bag.size()), dog.GetDirection(),
+                     dog.GetPosition(), dog.GetSpeed(), dog.GetBagCapacity(), dog.GetScore()});
+    names_.append(name);
+    bags_.insert(bags_.end(), bag.begin(), bag.end());
+}
+
+model::Dog GameStateSnapshot::RestoreDog(size_t index) const {
+    const DogRecord& record = dogs_.at(index);
+
+    model::Dog dog{model::Dog::Id{record.id}, names_.substr(record.name_offset, record.name_size),
+                   record.pos, record.bag_capacity};
+    dog.SetSpeed(record.speed);
+    dog.SetDirection(record.direction);
+    dog.AddScore(record.score);
+    for (uint32_t i = 0; i < record.bag_size; ++i) {
+        if (!dog.PutToBag(bags_[record.bag_offset + i])) {
+            throw std::runtime_error("Failed to put bag content");
+        }
+    }
+    return dog;
+}
+
+void GameStateSnapshot::Clear() noexcept {
+    tick_ = 0;
+    log_position_ = 0;
+    dogs_.clear();
+    names_.clear();
+    bags_.clear();
+}
+
+void GameStateSnapshot::Encode(std::string& out) const {
+    // Заголовок, 57 байт на собаку без учёта имени и рюкзака, 8 байт на предмет
+    out.reserve(out.size() + 32 + dogs_.size() * 57 + names_.size() + bags_.size() * 8);
+
+    BinaryWriter writer{out};
+    writer.Bytes(MAGIC);
+    writer.Uint(FORMAT_VERSION);
+    writer.Uint(tick_);
+    writer.Uint(log_position_);
+    writer.Uint(uint64_t{dogs_.size()});
+
+    for (const DogRecord& dog : dogs_) {
+        writer.Uint(dog.id);
+        writer.String(std::string_view{names_}.substr(dog.name_offset, dog.name_size));
+        writer.Double(dog.pos.x);
+        writer.Double(dog.pos.y);
+        writer.Double(dog.speed.x);
+        writer.Double(dog.speed.y);
+        writer.Uint(static_cast<uint8_t>(dog.direction));
+        writer.Uint(dog.bag_capacity);
+        writer.Uint(dog.score);
+        writer.Uint(dog.bag_size);
+        for (uint32_t i = 0; i < dog.bag_size; ++i) {
+            const model::FoundObject& item = bags_[dog.bag_offset + i];
+            writer.Uint(*item.id);
+            writer.Uint(item.type);
+        }
+    }
+}
+
+GameStateSnapshot GameStateSnapshot::Decode(std::string_view data) {
+    BinaryReader reader{data};
+    if (reader.Bytes(MAGIC.size()) != MAGIC) {
+        throw std::runtime_error("Not a game state snapshot");
+    }
+    const auto version = reader.Uint<uint32_t>();
+    if (version == 0 || version > FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot format version "s
+                                 + std::to_string(version));
+    }
+
+    GameStateSnapshot snapshot;
+    snapshot.tick_ = reader.Uint<uint64_t>();
+    if (version >= FIRST_LOG_POSITION_VERSION) {
+        snapshot.log_position_ = reader.Uint<uint64_t>();
+    }
+    const auto dog_count = reader.Uint<uint64_t>();
+
+    // Число собак не проверено, поэтому память под них не резервируется заранее
+    for (uint64_t i = 0; i < dog_count; ++i) {
+        DogRecord dog{};
+        dog.id = reader.Uint<uint32_t>();
+        const auto name = reader.String();
+        dog.name_offset = CheckedSize(snapshot.names_.size());
+        dog.name_size = CheckedSize(name.size());
+        snapshot.names_.append(name);
+        dog.pos.x = reader.Double();
+        dog.pos.y = reader.Double();
+        dog.speed.x = reader.Double();
+        dog.speed.y = reader.Double();
+        dog.direction = DirectionFromByte(reader.Uint<uint8_t>());
+        dog.bag_capacity = reader.Uint<uint64_t>();
+        dog.score = reader.Uint<uint32_t>();
+        dog.bag_size = reader.Uint<uint32_t>();
+        if (dog.bag_capacity > MAX_BAG_CAPACITY || dog.bag_size > dog.bag_capacity) {
+            throw std::runtime_error("Invalid bag capacity in snapshot");
+        }
+        dog.bag_offset = CheckedSize(snapshot.bags_.size());
+        for (uint32_t j = 0; j < dog.bag_size; ++j) {
+            const auto id = reader.Uint<uint32_t>();
+            const auto type = reader.Uint<uint32_t>();
+            snapshot.bags_.push_back({model::FoundObject::Id{id}, type});
+        }
+        snapshot.dogs_.push_back(dog);
+    }
+
+    if (!reader.AtEnd()) {
+        throw std::runtime_error("Unexpected data after the end of snapshot");
+    }
+    return snapshot;
+}
+
+}  // namespace serialization
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model.h"
+
+namespace serialization {
+
+/*
+ * Снимок состояния игры в плоских буферах: записи собак фиксированного размера,
+ * имена подряд в одной строке, содержимое рюкзаков подряд в одном векторе.
+ * Захват копирует O(собак) данных и не выделяет память, если буферы уже
+ * достаточно велики, поэтому его можно делать прямо на потоке тика.
+ */
+class GameStateSnapshot {
+public:
+    // Версия бинарного формата, которую пишет Encode. Decode читает и прежние версии.
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    uint64_t GetTick() const noexcept {
+        return tick_;
+    }
+
+    void SetTick(uint64_t tick) noexcept {
+        tick_ = tick;
+    }
+
+    // Номер последней записи журнала действий, уже учтённой в снимке (0 - ни одной).
+    // При восстановлении журнал проигрывается начиная со следующей записи.
+    uint64_t GetLogPosition() const noexcept {
+        return log_position_;
+    }
+
+    void SetLogPosition(uint64_t position) noexcept {
+        log_position_ = position;
+    }
+
+    size_t GetDogCount() const noexcept {
+        return dogs_.size();
+    }
+
+    void AddDog(const model::Dog& dog);
+
+    [[nodiscard]] model::Dog RestoreDog(size_t index) const;
+
+    // Очищает снимок, сохраняя выделенную память
+    void Clear() noexcept;
+
+    // Дописывает снимок в out в бинарном формате версии FORMAT_VERSION
+    void Encode(std::string& out) const;
+
+    // Бросает std::runtime_error, если данные повреждены или версия формата неизвестна
+    [[nodiscard]] static GameStateSnapshot Decode(std::string_view data);
+
+private:
+    struct DogRecord {
+        uint32_t id;
+        uint32_t name_offset;
+        uint32_t name_size;
+        uint32_t bag_offset;
+        uint32_t bag_size;
+        model::Direction direction;
+        geom::Point2D pos;
+        geom::Vec2D speed;
+        uint64_t bag_capacity;
+        model::Score score;
+    };
+
+    uint64_t tick_ = 0;
+    uint64_t log_position_ = 0;
+    std::vector<DogRecord> dogs_;
+    std::string names_;
+    std::vector<model::FoundObject> bags_;
+};
+
+}  // namespace serialization
@@ -0,0 +1,224 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/action_log.h"
+#include "temp_dir.h"
+
+using namespace model;
+using namespace serialization;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+using Records = std::vector<std::pair<uint64_t, LogEvent>>;
+
+size_t SegmentCount(const fs::path& dir) {
+    return static_cast<size_t>(std::distance(fs::directory_iterator{dir}, {}));
+}
+
+LogEvent MakeEvent(uint64_t i) {
+    switch (i % 3) {
+        case 0:
+            return JoinEvent{Dog::Id{static_cast<uint32_t>(i)}, "Dog "s + std::to_string(i),
+                             "map1"s};
+        case 1:
+            return ActionEvent{Dog::Id{static_cast<uint32_t>(i)},
+                               i % 5 ? std::optional{static_cast<Direction>(i % 4)}
+                                     : std::nullopt};
+        default:
+            return TickEvent{std::chrono::milliseconds{static_cast<int64_t>(i * 10)}};
+    }
+}
+
+Records Replay(const fs::path& dir, uint64_t after_position, ReplayResult* result = nullptr) {
+    Records records;
+    const auto replayed =
+        ReplayActionLog(dir, after_position, [&records](uint64_t position, const LogEvent& event) {
+            records.emplace_back(position, event);
+        });
+    if (result) {
+        *result = replayed;
+    }
+    return records;
+}
+
+Records ExpectedRecords(uint64_t first, uint64_t last) {
+    Records records;
+    for (uint64_t i = first; i <= last; ++i) {
+        records.emplace_back(i, MakeEvent(i));
+    }
+    return records;
+}
+
+void AppendEvents(ActionLog& log, uint64_t first, uint64_t last) {
+    for (uint64_t i = first; i <= last; ++i) {
+        CHECK(log.Append(MakeEvent(i)) == i);
+    }
+}
+
+}  // namespace
+
+SCENARIO("Action log") {
+    TempDir dir{"action-log-tests-"sv};
+
+    GIVEN("an empty log directory") {
+        THEN("there is nothing to replay") {
+            ReplayResult result{};
+            CHECK(Replay(dir.path, 0, &result).empty());
+            CHECK(result.last_position == 0);
+            CHECK_FALSE(result.damaged);
+        }
+    }
+
+    GIVEN("a log with events of every kind") {
+        {
+            ActionLog log{dir.path, 1};
+            AppendEvents(log, 1, 30);
+            CHECK(log.GetLastPosition() == 30);
+            log.WaitDurable(30);
+        }
+
+        THEN("all events are replayed in order") {
+            ReplayResult result{};
+            CHECK(Replay(dir.path, 0, &result) == ExpectedRecords(1, 30));
+            CHECK(result.last_position == 30);
+            CHECK_FALSE(result.damaged);
+        }
+
+        THEN("replay skips events already included in a snapshot") {
+            CHECK(Replay(dir.path, 25) == ExpectedRecords(26, 30));
+            CHECK(Replay(dir.path, 30).empty());
+        }
+
+        WHEN("the last record is torn by a crash") {
+            const auto segment = fs::directory_iterator{dir.path}->path();
+            fs::resize_file(segment, fs::file_size(segment) - 3);
+
+            THEN("replay stops before it and reports the damage") {
+                ReplayResult result{};
+                CHECK(Replay(dir.path, 0, &result) == ExpectedRecords(1, 29));
+                CHECK(result.last_position == 29);
+                CHECK(result.damaged);
+            }
+
+            AND_WHEN("the log is continued after replay") {
+                const auto last = ReplayActionLog(dir.path, 0, [](auto, const auto&) {
+                                  }).last_position;
+                {
+                    ActionLog log{dir.path, last + 1};
+                    AppendEvents(log, last + 1, 40);
+                    log.WaitDurable(40);
+                }
+
+                THEN("new events follow the surviving ones") {
+                    ReplayResult result{};
+                    CHECK(Replay(dir.path, 0, &result) == ExpectedRecords(1, 40));
+                    CHECK_FALSE(result.damaged);
+                }
+            }
+        }
+
+        WHEN("a record in the middle is corrupted") {
+            const auto segment = fs::directory_iterator{dir.path}->path();
+            std::fstream file{segment, std::ios::in | std::ios::out | std::ios::binary};
+            file.seekp(static_cast<std::streamoff>(fs::file_size(segment) / 2));
+            file.put('\x7f');
+            file.close();
+
+            THEN("only the records before it are replayed") {
+                ReplayResult result{};
+                const auto records = Replay(dir.path, 0, &result);
+                CHECK(result.damaged);
+                CHECK(records.size() < 30);
+                CHECK(records == ExpectedRecords(1, records.size()));
+            }
+        }
+    }
+
+    GIVEN("a log of several segments with a corrupted record in the first one") {
+        {
+            ActionLog log{dir.path, 1, 64};
+            for (uint64_t i = 1; i <= 20; ++i) {
+                log.Append(MakeEvent(i));
+                log.WaitDurable(i);
+            }
+        }
+        REQUIRE(SegmentCount(dir.path) > 2);
+        fs::path first_segment;
+        for (const auto& entry : fs::directory_iterator{dir.path}) {
+            if (first_segment.empty() || entry.path() < first_segment) {
+                first_segment = entry.path();
+            }
+        }
+        {
+            std::fstream file{first_segment, std::ios::in | std::ios::out | std::ios::binary};
+            file.seekp(static_cast<std::streamoff>(fs::file_size(first_segment) - 1));
+            file.put('\x7f');
+        }
+
+        ReplayResult result{};
+        const auto survived = Replay(dir.path, 0, &result);
+        REQUIRE(result.damaged);
+        REQUIRE(result.last_position < 20);
+        CHECK(survived == ExpectedRecords(1, result.last_position));
+
+        WHEN("the log is continued after replay") {
+            const uint64_t last = result.last_position + 3;
+            {
+                ActionLog log{dir.path, result.last_position + 1, 64};
+                AppendEvents(log, result.last_position + 1, last);
+                log.WaitDurable(last);
+            }
+
+            THEN("records of the abandoned segments are not replayed") {
+                ReplayResult continued{};
+                CHECK(Replay(dir.path, 0, &continued) == ExpectedRecords(1, last));
+                CHECK(continued.last_position == last);
+                CHECK_FALSE(continued.damaged);
+            }
+        }
+    }
+
+    GIVEN("a log with small segments") {
+        ActionLog log{dir.path, 1, 64};
+        for (uint64_t i = 1; i <= 20; ++i) {
+            log.Append(MakeEvent(i));
+            log.WaitDurable(i);
+        }
+        const size_t segments = SegmentCount(dir.path);
+        REQUIRE(segments > 2);
+
+        WHEN("segments covered by a snapshot are removed") {
+            log.RemoveUpTo(12);
+
+            THEN("everything after the snapshot can still be replayed") {
+                CHECK(SegmentCount(dir.path) < segments);
+                CHECK(Replay(dir.path, 12) == ExpectedRecords(13, 20));
+            }
+
+            THEN("older events are reported as lost") {
+                ReplayResult result{};
+                CHECK(Replay(dir.path, 0, &result).empty());
+                CHECK(result.damaged);
+            }
+        }
+
+        WHEN("everything is covered by a snapshot") {
+            log.RemoveUpTo(20);
+
+            THEN("the current segment is kept") {
+                CHECK(SegmentCount(dir.path) == 1);
+                log.Append(MakeEvent(21));
+                log.WaitDurable(21);
+                CHECK(Replay(dir.path, 20) == ExpectedRecords(21, 21));
+            }
+        }
+    }
+}
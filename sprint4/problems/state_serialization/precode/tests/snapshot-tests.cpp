@@ -0,0 +1,207 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "../src/snapshotter.h"
+#include "../src/state_snapshot.h"
+#include "temp_dir.h"
+
+using namespace model;
+using namespace serialization;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+Dog MakeDog(uint32_t id, std::string name, size_t bag_items) {
+    Dog dog{Dog::Id{id}, std::move(name), {id * 1.5, -0.25}, 3};
+    dog.SetSpeed({0.1 * id, -2.0});
+    dog.SetDirection(id % 2 ? Direction::WEST : Direction::SOUTH);
+    dog.AddScore(id * 10);
+    for (size_t i = 0; i < bag_items; ++i) {
+        CHECK(dog.PutToBag({FoundObject::Id{static_cast<uint32_t>(id * 100 + i)},
+                            static_cast<LostObjectType>(i)}));
+    }
+    return dog;
+}
+
+void CheckSameDog(const Dog& dog, const Dog& restored) {
+    CHECK(dog.GetId() == restored.GetId());
+    CHECK(dog.GetName() == restored.GetName());
+    CHECK(dog.GetPosition() == restored.GetPosition());
+    CHECK(dog.GetSpeed() == restored.GetSpeed());
+    CHECK(dog.GetDirection() == restored.GetDirection());
+    CHECK(dog.GetScore() == restored.GetScore());
+    CHECK(dog.GetBagCapacity() == restored.GetBagCapacity());
+    CHECK(dog.GetBagContent() == restored.GetBagContent());
+}
+
+}  // namespace
+
+SCENARIO("Game state snapshot encoding") {
+    GIVEN("a snapshot with several dogs") {
+        const std::vector<Dog> dogs{MakeDog(1, "Pluto"s, 0), MakeDog(2, ""s, 3),
+                                    MakeDog(3, "A dog with a rather long name"s, 1)};
+        GameStateSnapshot snapshot;
+        snapshot.SetTick(12345);
+        snapshot.SetLogPosition(777);
+        for (const auto& dog : dogs) {
+            snapshot.AddDog(dog);
+        }
+
+        WHEN("it is encoded and decoded") {
+            std::string data;
+            snapshot.Encode(data);
+            const auto restored = GameStateSnapshot::Decode(data);
+
+            THEN("the state is restored exactly") {
+                CHECK(restored.GetTick() == 12345);
+                CHECK(restored.GetLogPosition() == 777);
+                REQUIRE(restored.GetDogCount() == dogs.size());
+                for (size_t i = 0; i < dogs.size(); ++i) {
+                    CheckSameDog(dogs[i], restored.RestoreDog(i));
+                }
+            }
+        }
+
+        WHEN("it was saved in format version 1") {
+            std::string data;
+            snapshot.Encode(data);
+            // Версия 1 не содержала позиции журнала, которая идёт сразу после тика
+            data.erase(16, 8);
+            data[4] = 1;
+            const auto restored = GameStateSnapshot::Decode(data);
+
+            THEN("it is restored with no log position") {
+                CHECK(restored.GetTick() == 12345);
+                CHECK(restored.GetLogPosition() == 0);
+                REQUIRE(restored.GetDogCount() == dogs.size());
+                for (size_t i = 0; i < dogs.size(); ++i) {
+                    CheckSameDog(dogs[i], restored.RestoreDog(i));
+                }
+            }
+        }
+
+        WHEN("the encoded data is damaged") {
+            std::string data;
+            snapshot.Encode(data);
+
+            THEN("decoding fails instead of restoring garbage") {
+                for (size_t size = 0; size < data.size(); ++size) {
+                    CHECK_THROWS_AS(GameStateSnapshot::Decode(data.substr(0, size)),
+                                    std::runtime_error);
+                }
+                CHECK_THROWS_AS(GameStateSnapshot::Decode(data + "x"s), std::runtime_error);
+
+                auto bad_magic = data;
+                bad_magic[0] = 'X';
+                CHECK_THROWS_AS(GameStateSnapshot::Decode(bad_magic), std::runtime_error);
+
+                auto bad_version = data;
+                bad_version[4] = static_cast<char>(GameStateSnapshot::FORMAT_VERSION + 1);
+                CHECK_THROWS_AS(GameStateSnapshot::Decode(bad_version), std::runtime_error);
+
+                // Вместимость рюкзака собаки идёт после id, имени, координат, скорости и
+                // направления. У первой собаки имя "Pluto" и пустой рюкзак, у второй - пустое
+                // имя и три предмета.
+                constexpr size_t first_capacity = 32 + 4 + (4 + 5) + 32 + 1;
+                constexpr size_t second_capacity = first_capacity + 8 + 4 + 4 + 4 + 4 + 32 + 1;
+                REQUIRE(data[first_capacity] == 3);
+                REQUIRE(data[second_capacity] == 3);
+
+                auto huge_bag = data;
+                huge_bag[first_capacity + 7] = '\x7f';
+                CHECK_THROWS_AS(GameStateSnapshot::Decode(huge_bag), std::runtime_error);
+
+                auto small_bag = data;
+                small_bag[second_capacity] = 2;
+                CHECK_THROWS_AS(GameStateSnapshot::Decode(small_bag), std::runtime_error);
+            }
+        }
+
+        WHEN("it is cleared") {
+            snapshot.Clear();
+
+            THEN("it is empty and can be filled again") {
+                CHECK(snapshot.GetDogCount() == 0);
+                CHECK(snapshot.GetTick() == 0);
+                CHECK(snapshot.GetLogPosition() == 0);
+                snapshot.AddDog(dogs[1]);
+                REQUIRE(snapshot.GetDogCount() == 1);
+                CheckSameDog(dogs[1], snapshot.RestoreDog(0));
+            }
+        }
+    }
+}
+
+SCENARIO("Background snapshotter") {
+    TempDir dir{"snapshot-tests-"sv};
+    const auto path = dir.path / "state.bin";
+
+    GIVEN("no saved state") {
+        THEN("there is nothing to load") {
+            CHECK_FALSE(LoadSnapshot(path).has_value());
+        }
+    }
+
+    GIVEN("a snapshotter") {
+        const Dog dog = MakeDog(7, "Rex"s, 2);
+
+        WHEN("several snapshots are submitted") {
+            {
+                Snapshotter snapshotter{path};
+                GameStateSnapshot snapshot;
+                for (uint64_t tick = 1; tick <= 10; ++tick) {
+                    snapshot.SetTick(tick);
+                    snapshot.SetLogPosition(tick * 100);
+                    snapshot.AddDog(dog);
+                    snapshotter.Submit(snapshot);
+                    CHECK(snapshot.GetDogCount() == 0);
+                }
+                snapshotter.Flush();
+
+                THEN("the last one is on disk after Flush") {
+                    const auto loaded = LoadSnapshot(path);
+                    REQUIRE(loaded.has_value());
+                    CHECK(loaded->GetTick() == 10);
+                    CHECK(snapshotter.GetSavedLogPosition() == 1000);
+                    REQUIRE(loaded->GetDogCount() == 1);
+                    CheckSameDog(dog, loaded->RestoreDog(0));
+                    CHECK_FALSE(fs::exists(dir.path / "state.bin.tmp"));
+                }
+
+                snapshot.SetTick(11);
+                snapshotter.Submit(snapshot);
+            }
+
+            THEN("the destructor writes the snapshot submitted last") {
+                const auto loaded = LoadSnapshot(path);
+                REQUIRE(loaded.has_value());
+                CHECK(loaded->GetTick() == 11);
+                CHECK(loaded->GetDogCount() == 0);
+            }
+        }
+
+        WHEN("the file cannot be written") {
+            Snapshotter snapshotter{dir.path / "missing" / "state.bin"};
+            GameStateSnapshot snapshot;
+            snapshotter.Submit(snapshot);
+
+            THEN("Flush reports the error once") {
+                CHECK_THROWS(snapshotter.Flush());
+                CHECK_NOTHROW(snapshotter.Flush());
+            }
+        }
+    }
+
+    GIVEN("a corrupted file") {
+        std::ofstream{path, std::ios::binary} << "garbage"s;
+
+        THEN("loading fails") {
+            CHECK_THROWS_AS(LoadSnapshot(path), std::runtime_error);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Временный каталог, который удаляется вместе с содержимым
+struct TempDir {
+    explicit TempDir(std::string_view prefix)
+        : path(std::filesystem::temp_directory_path()
+               / (std::string{prefix} + std::to_string(reinterpret_cast<uintptr_t>(this)))) {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    std::filesystem::path path;
+};